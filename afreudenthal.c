@@ -1,6 +1,16 @@
-#include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+
+#include "primes.h"
+#include "pool.h"
+#include "out.h"
+#include "bench.h"
+#include "arena.h"
+#include "pairs.h"
 
 
 /*
@@ -40,6 +50,36 @@
 
    argv[ 2 ] is the sum's upper bound
 
+   Both may be preceded by the options:
+
+   -j N evaluates the statements on N threads, the
+   output stays the same
+
+   -v N prints the survivors of S2 alone (0), the
+   number of survivors of every statement along with
+   them (1) or all the survivors (2, the default)
+
+   -o FILE prints into FILE rather than onto stdout
+
+   --sweep takes three numbers: the numbers' lower bound
+   and a range of the sum's upper bounds, all of which
+   are solved in one go, printing the survivors of S2
+   alone for each one of them:
+      ./afreudenthal --sweep 2 99 1000
+
+   --bench reports the wall time of each phase of the
+   run onto stderr, as a line of JSON, see bench.h:
+      ./afreudenthal --bench -v 0 -o /dev/null 2 10000
+
+   --stats reports the same as a table, built with
+   -DFR_STATS both report the counters below as well
+
+   --survivors prints, instead of the above, the pairs
+   of numbers that survive each of P1, S1, P2 and S2,
+   a pair a line, for crosscheck.sh to compare with
+   those of cfreudenthal:
+      P1 x y
+
    The program's input is inclusive - all the tests to
    generate the relevant sets of numbers are
    "greater/less than or equal to"
@@ -48,6 +88,11 @@
    is:
       ./afreudenthal 2 99
 
+   The program is built along with the shared primality
+   engine, thread pool, output and memory arena:
+      cc -O2 -o afreudenthal afreudenthal.c primes.c pool.c out.c \
+         bench.c arena.c -lm -lpthread
+
    The program outputs the pairs of numbers along with
    the corresponding product/sum survivors of the
    consecutive statements made by P and S
@@ -55,71 +100,351 @@
  */
 
 
+/*
+   The pairs are not kept: they go in the order
+   of pairIndex(), so that a pair is had from its
+   place - by pairAt(), or by stepping on from
+   the pair before, see pairSkip(). What is kept
+   is a bit plane per statement, a bit per pair
+   set if the pair passes it (prodpp1, sumps1,
+   prodpp2 and sumps2 of the output)
+
+   A pair passes a statement only if it passes
+   the ones before, so that a statement need only
+   go through the pairs set in the plane before
+   its own, 64 of them to a word
+
+   'fr_t' is a pair as the pairs are gone
+   through, 'i' is its place
+ */
+#define STAGE_P1		0
+#define STAGE_S1		1
+#define STAGE_P2		2
+#define STAGE_S2		3
+#define N_STAGES		4
+
 typedef struct
 {
 	int		x;
 	int		y;
 	int		sum;
-	int		prod;
-
-	int		prodpp1; /* this product passes P1 */
-	int		sumps1; /* this sum passes S1 */
-	int		prodpp2; /* this product passes P2 */
-	int		sumps2; /* this sum passes S2 */
+	prod_t		prod;
+	idx_t		i;
 } fr_t;
 
 
-static void		checkP1( fr_t*, int );
-static int		prodPassesP1( int );
+/*
+   The counters of a build with -DFR_STATS,
+   see bench.h
+ */
+#define STAT_PAIRS		0 /* gone through by each statement */
+#define STAT_FACTORIZATIONS	1 /* P1 past the table, P2 */
+#define STAT_IS_PRIME		2 /* calls of isPrime() */
+#define STAT_SUM_PASSES_S1	3 /* calls of sumPassesS1(), past the table */
+#define STAT_PROD_PASSES_P2	4
+#define STAT_SUM_PASSES_S2	5
+#define STAT_PASSED		6 /* survivors of each statement */
+#define N_STATS			7
+
+
+/*
+   The outcomes of S1, P2 and S2 depend on the
+   sum or the product alone, yet the same sums
+   and products come up over and over again:
+   each one is evaluated once and remembered in
+   a table indexed by its value
+
+   S1 is had up front for all the sums at once,
+   see mkGoldbach(): 'goldbach' holds the number
+   of ways a sum goes as a sum of two primes, the
+   sum passes S1 if there is none. So is P1 for
+   all the products, see mkSemiprimes(): a bit
+   per product, set if it is a semiprime
+
+   The tables hold MEMO_UNKNOWN, the zeros they
+   come mapped with, for "not yet known", so that
+   none of their pages is touched before it is
+   used. A value outside of a table (or no table
+   at all) is simply evaluated every time
+
+   Any number of threads may fill the tables at
+   once: all of them would store the same value
+ */
+#define MEMO_UNKNOWN		0
+#define MEMO_FAILS		1
+#define MEMO_PASSES		2
+
+typedef struct
+{
+	int		minInt;
+	int		maxInt;
+
+	sieve_t*	sieve; /* sieved up to 'maxSum' */
+
+	int		maxSum; /* is the size of 'goldbach' and 's2' less 1 */
+	prod_t		maxProd; /* is the size of 'p2' less 1 */
+	int*		goldbach; /* per sum: its sums of two primes */
+	uint64_t*	rev; /* the sieve's 'odd' reversed, see mkGoldbach() */
+	int		nRev; /* is the number of the bits in 'rev' */
+	uint64_t*	semiprimes; /* a bit per product up to 'maxProd': fails P1 */
+	signed char*	p2; /* per product: passes P2 */
+	signed char*	s2; /* per sum: passes S2 */
 
-static void		checkS1( fr_t*, int );
-static int		sumPassesS1( int );
+	/*
+	   While sweeping, P2 and S2 are forgotten
+	   as the bound (hence 'maxInt') changes: the
+	   products whose P2 is remembered are listed
+	   so as to forget just those, unless the list
+	   could not grow and 'p2Lost' is set
+	 */
+	int*		p2Set;
+	int		nP2Set;
+	int		p2SetSize;
+	char		p2Lost;
+} memo_t;
 
-static void		checkP2( fr_t*, int, int, int );
-static int		prodPassesP2( int, int, int );
 
-static void		checkS2( fr_t*, int, int, int );
-static int		sumPassesS2( int, int, int );
+/*
+   Runs a statement over all the pairs, on as
+   many threads as its pool has: the pairs are
+   split into 'nShards' consecutive shards, each
+   one printing into its own buffer, and the
+   buffers are written out in the shards' order,
+   with one writev(), which makes for the same
+   output as that of a single thread's
+
+   A shard starts at a word of the planes, for
+   the threads not to share the words they set
+
+   'stage' is the statement under way, one of
+   STAGE_*
+ */
+typedef struct
+{
+	uint64_t*	passed[ N_STAGES ]; /* the planes, a bit per pair */
+	idx_t		n;
+	int		minInt; /* the bounds the pairs are of */
+	int		maxSum;
+	memo_t*		memo;
+
+	pool_t		pool;
+	int		nShards;
+	out_t*		bufs; /* one per shard */
+	idx_t*		nPassed; /* per shard */
+
+	out_t		out;
+	int		verbose; /* is one of VERBOSE_* */
+
+	int		stage;
+	char		quiet; /* evaluate, but print nothing */
+} run_t;
+
+
+static void		checkP1( run_t* );
+static int		stepP1( fr_t*, memo_t* );
+static int		prodPassesP1( memo_t*, int, int );
+static int		memoP1( memo_t*, int, int );
+
+static void		checkS1( run_t* );
+static int		stepS1( fr_t*, memo_t* );
+static int		sumPassesS1( memo_t*, int );
+static int		memoS1( memo_t*, int );
+
+static void		checkP2( run_t* );
+static int		stepP2( fr_t*, memo_t* );
+static int		prodPassesP2( memo_t*, int, int );
+static int		memoP2( memo_t*, int, int );
+
+static void		checkS2( run_t* );
+static int		stepS2( fr_t*, memo_t* );
+static int		sumPassesS2( memo_t*, int );
+static int		memoS2( memo_t*, int );
+
+static void		runCheck( run_t*, int, const char*, int );
+static idx_t		runStage( run_t*, int );
+static void		runShards( void*, int64_t, int64_t, int );
+static idx_t		runPairs( run_t*, idx_t, idx_t, out_t* );
+static void		pairSkip( run_t*, fr_t*, idx_t );
+static void		pairOf( run_t*, fr_t*, idx_t );
+static int		passed( run_t*, int, idx_t );
+
+static void		sweep( run_t*, arena_t*, int, int, int );
+static void		forgetP2S2( memo_t* );
+static void		memoP2Set( memo_t*, int );
+static int		cmpIdx( const void*, const void* );
+
+static uint64_t*	init( int, char* [], arena_t*, int*, int*, idx_t*, int*,
+				int*, int*, int*, int*, int*, int* );
+static size_t		arenaBytes( idx_t, int, int, int );
+static size_t		planeBytes( idx_t );
+static size_t		sizeMemo( memo_t*, int, int );
+static memo_t*		mkMemo( memo_t*, sieve_t*, arena_t*, int, int );
+static void		rmMemo( memo_t* );
+static run_t*		mkRun( run_t*, uint64_t*, idx_t, int, int, memo_t*, int,
+				int );
+static int		rmRun( run_t* );
+static void		mkGoldbach( run_t* );
+static void		mkGoldbachIn( void*, int64_t, int64_t, int );
+static int		nGoldbach( memo_t*, int );
+static void		mkSemiprimes( run_t* );
+static void		mkSemiprimesIn( void*, int64_t, int64_t, int );
+static void		printFrRow( run_t*, fr_t*, out_t* );
+static void		printFr( run_t* );
+static void		printSurvivors( run_t* );
 
-static int		isPrime( int n );
 
-static fr_t*		init( int, char* [], int*, int*, int* );
-static int		mkPairs( fr_t*, int, int );
-static void		printFrRow( fr_t* );
-static void		printFr( fr_t*, int );
+/*
+   The statements' steps, by STAGE_*
+ */
+static int		( * const steps[ N_STAGES ] )( fr_t*, memo_t* ) =
+{
+	stepP1, stepS1, stepP2, stepS2
+};
 
 
 extern int
 main( int argc, char* argv[] )
 {
-	fr_t*		fr;
-	int		N = 0;
+	uint64_t*	planes;
+	sieve_t		sieve;
+	memo_t		memo = { 0 };
+	run_t		run;
+	arena_t		arena;
+	idx_t		N = 0;
 	int		minInt = 0;
-	int		maxInt = 0;
 	int		sumUBound = 0;
+	int		nThreads = 1;
+	int		sweepFrom = 0;
+	int		verbose = VERBOSE_FULL;
+	int		fd = STDOUT_FILENO;
+	int		benchOn = 0;
+	int		statsOn = 0;
+	int		survivors = 0;
+	bench_t		bench;
+	out_t		err;
+	int		ec = 0;
+#ifdef FR_STATS
+	static const char*	statNames[ N_STATS ] =
+	{
+		"pairs", "factorizations", "isPrime", "sumPassesS1",
+		"prodPassesP2", "sumPassesS2", "passed"
+	};
+#endif
+
 
+	mkBench( &bench, "afreudenthal" );
+#ifdef FR_STATS
+	benchCounters( &bench, statNames, N_STATS );
+#endif
 
-	fr = init( argc, argv, &minInt, &sumUBound, &N );
-	if ( !fr )
+	planes = init( argc, argv, &arena, &minInt, &sumUBound, &N, &nThreads,
+		&sweepFrom, &verbose, &fd, &benchOn, &statsOn, &survivors );
+	if ( !planes )
 	{
-		return 0;
+		ec = 1;
+		goto fail;
+	}
+
+	if ( !mkMemo( &memo, &sieve, &arena, minInt, sumUBound ) )
+	{
+		outErr( "afreudenthal", "no room for the sieve", NULL );
+		rmArena( &arena );
+		ec = 1;
+		goto fail;
+	}
+	benchPhase( &bench, "memo" );
+
+	if ( !mkRun( &run, planes, N, minInt, sumUBound, &memo, nThreads, fd ) )
+	{
+		outErr( "afreudenthal", "no room for the threads and their output",
+			NULL );
+		rmMemo( &memo );
+		rmArena( &arena );
+		ec = 1;
+		goto fail;
+	}
+	run.verbose = verbose;
+
+	mkGoldbach( &run );
+	benchPhase( &bench, "goldbach" );
+
+	mkSemiprimes( &run );
+	benchPhase( &bench, "semiprimes" );
+
+	if ( sweepFrom )
+	{
+		sweep( &run, &arena, minInt, sweepFrom, sumUBound );
+		benchPhase( &bench, "sweep" );
+		goto out;
 	}
 
-	maxInt = sumUBound - minInt;
+	/*
+	   The statements are evaluated quietly,
+	   their survivors are printed at the end
+	 */
+	if ( survivors )
+	{
+		run.quiet = 1;
+		runStage( &run, STAGE_P1 );
+		runStage( &run, STAGE_S1 );
+		runStage( &run, STAGE_P2 );
+		runStage( &run, STAGE_S2 );
+		benchPhase( &bench, "statements" );
+
+		printSurvivors( &run );
+		goto out;
+	}
+
+	printFr( &run );
+	benchPhase( &bench, "output" );
+
+	checkP1( &run );
+	benchPhase( &bench, "P1" );
+
+	checkS1( &run );
+	benchPhase( &bench, "S1" );
+
+	checkP2( &run );
+	benchPhase( &bench, "P2" );
 
-	printFr( fr, N );
+	checkS2( &run );
+	benchPhase( &bench, "S2" );
 
-	checkP1( fr, N );
+out:
+	if ( rmRun( &run ) < 0 )
+	{
+		ec = 1;
+	}
+	benchPhase( &bench, "output" );
 
-	checkS1( fr, N );
+	rmMemo( &memo );
 
-	checkP2( fr, N, minInt, maxInt );
+	rmArena( &arena );
 
-	checkS2( fr, N, minInt, maxInt );
+	if ( ( benchOn || statsOn ) && mkOut( &err, STDERR_FILENO ) )
+	{
+		bench.minInt = minInt;
+		bench.maxSum = sumUBound;
+		bench.nThreads = nThreads;
+		bench.nPairs = N;
+		if ( benchOn )
+		{
+			benchReport( &bench, &err );
+		}
+		if ( statsOn )
+		{
+			benchSummary( &bench, &err );
+		}
+		rmOut( &err );
+	}
 
-	free( fr );
+fail:
+	if ( fd > STDERR_FILENO )
+	{
+		close( fd );
+	}
 
-	return 0;
+	return ec;
 }
 
 
@@ -136,21 +461,20 @@ main( int argc, char* argv[] )
 
  */
 static void
-checkP1( fr_t* fr, int n )
+checkP1( run_t* run )
 {
-	int		i;
+	runCheck( run, STAGE_P1, "Products That Pass P1", VERBOSE_FULL );
+}
 
 
-	printf( "[Begin Products That Pass P1:\n" );
-	for ( i = 0; i < n; i++ )
-	{
-		fr[ i ].prodpp1 = prodPassesP1( fr[ i ].prod );
-		if ( fr[ i ].prodpp1 )
-		{
-			printFrRow( &fr[ i ] );
-		}
-	}
-	printf( ":end Products That Pass P1]\n" );
+/*
+   checkP1() of a single pair: returns 1
+   if the pair passes
+ */
+static int
+stepP1( fr_t* row, memo_t* memo )
+{
+	return memoP1( memo, row->x, row->y );
 }
 
 
@@ -163,28 +487,21 @@ checkP1( fr_t* fr, int n )
 
    then return 0, otherwise - return 1
 
+   That is the case iff 'p' has exactly two
+   prime factors, counted with multiplicity,
+   which are those of its factors 'x' and 'y'
+   put together
+
  */
 static int
-prodPassesP1( int product )
+prodPassesP1( memo_t* memo, int x, int y )
 {
-	int		a;
-	int		b;
-	int		sqroot = ( int )sqrt( ( double )product );
+	factors64_t	f;
 
 
-	for( a = 2; a <= sqroot; a++ )
-	{
-		if ( product % a == 0 )
-		{
-			b = product / a;
-			if ( isPrime( a ) && isPrime( b ) )
-			{
-				return 0;
-			}
-		}
-	}
+	BENCH_COUNT( STAT_FACTORIZATIONS, 1 );
 
-	return 1;
+	return factorizePair( memo->sieve, x, y, &f ) != 2;
 }
 
 
@@ -202,26 +519,20 @@ prodPassesP1( int product )
 
  */
 static void
-checkS1( fr_t* fr, int n )
+checkS1( run_t* run )
 {
-	int		i;
-
+	runCheck( run, STAGE_S1, "Sums That Pass S1", VERBOSE_FULL );
+}
 
-	printf( "[Begin Sums That Pass S1:\n" );
-	for ( i = 0; i < n; i++ )
-	{
-		if ( !fr[ i ].prodpp1 )
-		{
-			continue;
-		}
 
-		fr[ i ].sumps1 = sumPassesS1( fr[ i ].sum );
-		if ( fr[ i ].sumps1 )
-		{
-			printFrRow( &fr[ i ] );
-		}
-	}
-	printf( ":end Sums That Pass S1]\n" );
+/*
+   checkS1() of a single pair that passed
+   P1: returns 1 if it passes
+ */
+static int
+stepS1( fr_t* row, memo_t* memo )
+{
+	return memoS1( memo, row->sum );
 }
 
 
@@ -236,19 +547,26 @@ checkS1( fr_t* fr, int n )
 
  */
 static int
-sumPassesS1( int sum )
+sumPassesS1( memo_t* memo, int sum )
 {
 	int		a;
 	int		b;
 	int		half = sum / 2;
 
 
+	BENCH_COUNT( STAT_SUM_PASSES_S1, 1 );
+
 	for( a = 2; a <= half; a++ )
 	{
 		b = sum - a;
-		if ( isPrime( a ) && isPrime( b ) )
+		BENCH_COUNT( STAT_IS_PRIME, 1 );
+		if ( isPrime( memo->sieve, a ) )
 		{
-			return 0;
+			BENCH_COUNT( STAT_IS_PRIME, 1 );
+			if ( isPrime( memo->sieve, b ) )
+			{
+				return 0;
+			}
 		}
 	}
 
@@ -273,26 +591,20 @@ sumPassesS1( int sum )
 
  */
 static void
-checkP2( fr_t* fr, int n, int minint, int maxint )
+checkP2( run_t* run )
 {
-	int		i;
-
+	runCheck( run, STAGE_P2, "Products That Pass P2", VERBOSE_FULL );
+}
 
-	printf( "[Begin Products That Pass P2:\n" );
-	for ( i = 0; i < n; i++ )
-	{
-		if ( !fr[ i ].prodpp1 || !fr[ i ].sumps1 )
-		{
-			continue;
-		}
 
-		fr[ i ].prodpp2 = prodPassesP2( fr[ i ].prod, minint, maxint );
-		if ( fr[ i ].prodpp2 )
-		{
-			printFrRow( &fr[ i ] );
-		}
-	}
-	printf( ":end Products That Pass P2]\n" );
+/*
+   checkP2() of a single pair that passed
+   S1: returns 1 if it passes
+ */
+static int
+stepP2( fr_t* row, memo_t* memo )
+{
+	return memoP2( memo, row->x, row->y );
 }
 
 
@@ -301,42 +613,50 @@ checkP2( fr_t* fr, int n, int minint, int maxint )
    pairs of integers 'a' and 'b' such that:
 
       'a' * 'b' = 'p'
-      'minint' <= 'a', 'b' <= 'maxint'
+      'minInt' <= 'a', 'b' <= 'maxInt'
 
    one and only one pair sums to a number
    that passes S1 then return 1, otherwise -
    return 0
 
+   'p' is given as any pair of its factors,
+   'x' and 'y', which is what it is factored
+   by
+
  */
 static int
-prodPassesP2( int product, int minint, int maxint )
+prodPassesP2( memo_t* memo, int x, int y )
 {
-	int		a;
-	int		b;
+	int		i;
+	prod_t		a[ MAX_DIVISORS64 / 2 ];
+	int		na;
+	prod_t		product = ( prod_t )x * y;
+	prod_t		b;
 	int		sum;
 	int		cnt = 0;
-	int		sqroot = ( int )sqrt( ( double )product );
 
 
-	for( a = 2; a <= sqroot; a++ )
+	BENCH_COUNT( STAT_PROD_PASSES_P2, 1 );
+	BENCH_COUNT( STAT_FACTORIZATIONS, 1 );
+
+	na = factorPairsOf( memo->sieve, x, y, a );
+
+	for ( i = 0; i < na; i++ )
 	{
-		if ( product % a == 0 )
+		b = product / a[ i ];
+		if ( b < memo->minInt || b > memo->maxInt )
 		{
-			b = product / a;
-			if ( b < minint || b > maxint )
-			{
-				continue;
-			}
+			continue;
+		}
 
-			sum = a + b;
-			if ( sumPassesS1( sum ) )
+		sum = ( int )( a[ i ] + b );
+		if ( memoS1( memo, sum ) )
+		{
+			if ( cnt > 0 )
 			{
-				if ( cnt > 0 )
-				{
-					return 0;
-				}
-				cnt = 1;
+				return 0;
 			}
+			cnt = 1;
 		}
 	}
 
@@ -361,26 +681,20 @@ prodPassesP2( int product, int minint, int maxint )
 
  */
 static void
-checkS2( fr_t* fr, int n, int minint, int maxint )
+checkS2( run_t* run )
 {
-	int		i;
-
+	runCheck( run, STAGE_S2, "Sums That Pass S2", VERBOSE_ANSWERS );
+}
 
-	printf( "[Begin Sums That Pass S2:\n" );
-	for ( i = 0; i < n; i++ )
-	{
-		if ( !fr[ i ].prodpp1 || !fr[ i ].sumps1 || !fr[ i ].prodpp2 )
-		{
-			continue;
-		}
 
-		fr[ i ].sumps2 = sumPassesS2( fr[ i ].sum, minint, maxint );
-		if ( fr[ i ].sumps2 )
-		{
-			printFrRow( &fr[ i ] );
-		}
-	}
-	printf( ":end Sums That Pass S2]\n" );
+/*
+   checkS2() of a single pair that passed
+   P2: returns 1 if it passes
+ */
+static int
+stepS2( fr_t* row, memo_t* memo )
+{
+	return memoS2( memo, row->sum );
 }
 
 
@@ -389,7 +703,7 @@ checkS2( fr_t* fr, int n, int minint, int maxint )
    pairs of integers 'a' and 'b' such that:
 
       'a' + 'b' = 's'
-      'minint' <= 'a', 'b' <= 'maxint'
+      'minInt' <= 'a', 'b' <= 'maxInt'
 
    one and only one pair multiplies to a
    product that passes P2 then return 1,
@@ -397,20 +711,20 @@ checkS2( fr_t* fr, int n, int minint, int maxint )
 
  */
 static int
-sumPassesS2( int sum, int minint, int maxint )
+sumPassesS2( memo_t* memo, int sum )
 {
 	int		a;
 	int		b;
-	int		prod;
 	int		cnt = 0;
 	int		half = sum / 2;
 
 
+	BENCH_COUNT( STAT_SUM_PASSES_S2, 1 );
+
 	for( a = 2; a <= half; a++ )
 	{
 		b = sum - a;
-		prod = a * b;
-		if ( prodPassesP2( prod, minint, maxint ) )
+		if ( memoP2( memo, a, b ) )
 		{
 			if ( cnt > 0 )
 			{
@@ -424,136 +738,1168 @@ sumPassesS2( int sum, int minint, int maxint )
 }
 
 
-static fr_t*
-init( int argc, char* argv[], int* minint, int* sumubound, int* n )
+/*
+   Look up whether 'x' * 'y' passes P1: it
+   does if it is not a semiprime. The table
+   has those of the factors up to 'maxInt'
+   (the largest while sweeping), which are
+   all of them for 'x' and 'y' in the range
+ */
+static int
+memoP1( memo_t* memo, int x, int y )
 {
-	int		x;
-	int		y;
-	fr_t*		fr;
+	prod_t		product = ( prod_t )x * y;
 
 
-	if ( argc < 3 )
+	if ( !memo->semiprimes || product > memo->maxProd ||
+		x > memo->maxInt || y > memo->maxInt )
 	{
-		return NULL;
+		return prodPassesP1( memo, x, y );
 	}
 
-	*minint = atoi( argv[ 1 ] );
-	*sumubound = atoi( argv[ 2 ] );
+	return !( ( memo->semiprimes[ product >> 6 ] >> ( product & 63 ) ) & 1 );
+}
 
 
-	/*
-	   Compute the number of pairs first
-	 */
-	*n = mkPairs( NULL, *minint, *sumubound );
-	if ( *n == 0 )
+/*
+   Look up whether 'sum' passes S1: it does
+   if it has no sums of two primes
+ */
+static int
+memoS1( memo_t* memo, int sum )
+{
+	if ( !memo->goldbach || sum < 0 || sum > memo->maxSum )
 	{
-		return NULL;
+		return sumPassesS1( memo, sum );
 	}
 
-	fr = ( fr_t* )calloc( *n, sizeof( fr_t ) );
-	if ( !fr )
+	return memo->goldbach[ sum ] == 0;
+}
+
+
+/*
+   Look up (evaluating and remembering
+   it on the first use) whether 'x' * 'y'
+   passes P2
+ */
+static int
+memoP2( memo_t* memo, int x, int y )
+{
+	prod_t		product = ( prod_t )x * y;
+	signed char	v;
+
+
+	if ( !memo->p2 || product < 0 || product > memo->maxProd )
 	{
-		return NULL;
+		return prodPassesP2( memo, x, y );
 	}
 
+	v = __atomic_load_n( &memo->p2[ product ], __ATOMIC_RELAXED );
+	if ( v == MEMO_UNKNOWN )
+	{
+		v = prodPassesP2( memo, x, y ) ? MEMO_PASSES : MEMO_FAILS;
+		__atomic_store_n( &memo->p2[ product ], v, __ATOMIC_RELAXED );
 
-	/*
-	   Populate them next
-	 */
-	mkPairs( fr, *minint, *sumubound );
+		if ( memo->p2Set && !memo->p2Lost )
+		{
+			memoP2Set( memo, ( int )product );
+		}
+	}
 
-	return fr;
+	return v == MEMO_PASSES;
 }
 
 
+/*
+   Look up (evaluating and remembering
+   it on the first use) whether 'sum'
+   passes S2
+ */
 static int
-mkPairs( fr_t* fr, int minint, int sumubound )
+memoS2( memo_t* memo, int sum )
 {
-	int		x;
-	int		y;
-	int		n = 0;
+	signed char	v;
+
+
+	if ( !memo->s2 || sum < 0 || sum > memo->maxSum )
+	{
+		return sumPassesS2( memo, sum );
+	}
+
+	v = __atomic_load_n( &memo->s2[ sum ], __ATOMIC_RELAXED );
+	if ( v == MEMO_UNKNOWN )
+	{
+		v = sumPassesS2( memo, sum ) ? MEMO_PASSES : MEMO_FAILS;
+		__atomic_store_n( &memo->s2[ sum ], v, __ATOMIC_RELAXED );
+	}
+
+	return v == MEMO_PASSES;
+}
+
+
+/*
+   Evaluate a statement over all the pairs and
+   print those that pass it, between the lines
+   naming it, if the verbosity is at least
+   'printAt' - or else just their number, if
+   the verbosity asks for the counts
+ */
+static void
+runCheck( run_t* run, int stage, const char* name, int printAt )
+{
+	idx_t		n;
 
 
-	for ( x = minint; x <= sumubound; x++ )
+	if ( run->verbose < printAt )
 	{
-		for ( y = x + 1; y <= sumubound; y++ )
+		run->quiet = 1;
+		n = runStage( run, stage );
+		run->quiet = 0;
+
+		if ( run->verbose >= VERBOSE_COUNTS )
 		{
-			if ( ( x + y ) <= sumubound  )
-			{
-				if ( fr )
-				{
-					fr[ n ].x = x;
-					fr[ n ].y = y;
-					fr[ n ].sum = x + y;
-					fr[ n ].prod = x * y;
-				}
-				n++;
-			}
+			outStr( &run->out, name );
+			outStr( &run->out, ": " );
+			outInt( &run->out, n );
+			outChar( &run->out, '\n' );
 		}
+
+		return;
 	}
 
-	return n;
+	outStr( &run->out, "[Begin " );
+	outStr( &run->out, name );
+	outStr( &run->out, ":\n" );
+
+	runStage( run, stage );
+
+	outStr( &run->out, ":end " );
+	outStr( &run->out, name );
+	outStr( &run->out, "]\n" );
 }
 
 
-static int
-isPrime( int n )
+/*
+   Evaluate a statement over all the pairs,
+   printing those that pass it
+
+   Returns the number of such pairs
+ */
+static idx_t
+runStage( run_t* run, int stage )
 {
 	int		i;
-	int		sqroot;
+	idx_t		n = 0;
 
 
-	if ( n <= 3 )
-	{
-		return 1;
-	}
+	run->stage = stage;
 
-	if ( n % 2 == 0 )
+	if ( run->pool.nThreads <= 1 )
 	{
-		return 0;
+		n = runPairs( run, 0, run->n, &run->out );
+		BENCH_COUNT( STAT_PASSED, n );
+
+		return n;
 	}
 
-	sqroot = ( int )sqrt( ( double )n );
+	runPool( &run->pool, runShards, run, run->nShards );
+
+	outVec( &run->out, run->bufs, run->nShards );
 
-	for ( i = 2; i <= sqroot; i++ )
+	for ( i = 0; i < run->nShards; i++ )
 	{
-		if ( n % i == 0 )
-		{
-			return 0;
-		}
+		n += run->nPassed[ i ];
 	}
+	BENCH_COUNT( STAT_PASSED, n );
 
-	return 1;
+	return n;
 }
 
 
+/*
+   runStage() of the shards 'lo'
+   through 'hi' - 1
+ */
 static void
-printFrRow( fr_t* row )
+runShards( void* arg, int64_t lo, int64_t hi, int thread )
 {
-	printf( "%d %d"
-		"\t%d\t%d"
-		"\tprodpp1 = %d"
-		"\t\t sumps1 = %d"
-		"\tprodp2 = %d"
-		"\tsumps2 = %d\n",
-			row->x, row->y,
-			row->sum, row->prod,
-			row->prodpp1,
-			row->sumps1,
-			row->prodpp2,
-			row->sumps2 );
+	run_t*		run = ( run_t* )arg;
+	int		shard;
+	idx_t		first;
+	idx_t		last;
+
+
+	( void )thread;
+
+	for ( shard = lo; shard < hi; shard++ )
+	{
+		first = run->n * shard / run->nShards & ~( idx_t )63;
+		last = shard + 1 == run->nShards ? run->n :
+			run->n * ( shard + 1 ) / run->nShards & ~( idx_t )63;
+
+		run->nPassed[ shard ] = runPairs( run, first, last,
+			&run->bufs[ shard ] );
+	}
 }
 
 
-static void
-printFr( fr_t* fr, int n )
+/*
+   runStage() of the pairs 'first' through 'last'
+   - 1, 'first' at the start of a word: a word of
+   the plane before at a time, the pair is moved
+   on to each one set in it in turn, and the bits
+   of those that pass are set in the stage's own
+   plane - before they get printed into 'out'
+
+   Returns the number of the pairs that pass
+ */
+static idx_t
+runPairs( run_t* run, idx_t first, idx_t last, out_t* out )
 {
-	int		i;
+	uint64_t*	plane = run->passed[ run->stage ];
+	uint64_t*	before = run->stage > 0 ? run->passed[ run->stage - 1 ] :
+				NULL;
+	uint64_t	todo;
+	fr_t		row;
+	idx_t		w;
+	idx_t		at;
+	idx_t		n = 0;
+
+
+	if ( first >= last )
+	{
+		return 0;
+	}
 
+	pairOf( run, &row, first );
 
-	printf( "Total of %d Freudenthal pairs:\n", n );
-	for ( i = 0; i < n; i++ )
+	for ( w = first >> 6; w * 64 < last; w++ )
 	{
-		printFrRow( &fr[ i ] );
+		todo = before ? before[ w ] : ~( uint64_t )0;
+		if ( last - w * 64 < 64 )
+		{
+			todo &= ( ( uint64_t )1 << ( last - w * 64 ) ) - 1;
+		}
+		BENCH_COUNT( STAT_PAIRS, __builtin_popcountll( todo ) );
+
+		plane[ w ] = 0;
+		for ( ; todo; todo &= todo - 1 )
+		{
+			at = w * 64 + __builtin_ctzll( todo );
+			pairSkip( run, &row, at - row.i );
+
+			if ( steps[ run->stage ]( &row, run->memo ) )
+			{
+				plane[ w ] |= todo & -todo;
+				n++;
+				if ( !run->quiet )
+				{
+					printFrRow( run, &row, out );
+				}
+			}
+		}
+	}
+
+	return n;
+}
+
+
+/*
+   Move the pair 'k' pairs on: past the last y
+   of its x, the pairs go on with the next x,
+   from y = x + 1. 'k' may not take it past the
+   last pair
+ */
+static void
+pairSkip( run_t* run, fr_t* row, idx_t k )
+{
+	idx_t		y = row->y + k;
+	idx_t		past;
+
+
+	row->i += k;
+	while ( row->x + y > run->maxSum )
+	{
+		past = row->x + y - run->maxSum;
+		row->x++;
+		y = row->x + past;
+	}
+
+	row->y = ( int )y;
+	row->sum = row->x + row->y;
+	row->prod = ( prod_t )row->x * row->y;
+}
+
+
+/*
+   The pair at 'i', by pairAt()
+ */
+static void
+pairOf( run_t* run, fr_t* row, idx_t i )
+{
+	pairAt( run->minInt, run->maxSum, i, &row->x, &row->y );
+	row->sum = row->x + row->y;
+	row->prod = ( prod_t )row->x * row->y;
+	row->i = i;
+}
+
+
+/*
+   Whether the pair at 'i' passes the
+   statement 'stage'
+ */
+static int
+passed( run_t* run, int stage, idx_t i )
+{
+	return ( run->passed[ stage ][ i >> 6 ] >> ( i & 63 ) ) & 1;
+}
+
+
+/*
+   Solve for every sum's upper bound from
+   'from' through 'to', printing the survivors
+   of S2 of each one
+
+   The pairs are those of the largest bound,
+   those of a smaller one are the pairs that
+   add up to no more than it, in the same
+   order. P1 and S1 do not depend on the bound,
+   they are evaluated once for all the pairs;
+   P2 and S2 do, through the largest number
+   allowed, and are evaluated anew per bound
+   for the survivors of P1 and S1 - in the
+   order of their sums, so that a bound takes
+   the leading ones, up to its own sum
+ */
+static void
+sweep( run_t* run, arena_t* arena, int minint, int from, int to )
+{
+	uint64_t*	s1 = run->passed[ STAGE_S1 ];
+	uint64_t*	p2 = run->passed[ STAGE_P2 ];
+	uint64_t*	s2 = run->passed[ STAGE_S2 ];
+	memo_t*		memo = run->memo;
+	fr_t		row;
+	uint64_t	bit;
+	idx_t*		cand; /* survivors of S1, by sum */
+	idx_t*		found; /* survivors of S2, by pair */
+	idx_t*		start;
+	idx_t		ncand = 0;
+	idx_t		nfound;
+	int		bound;
+	idx_t		i;
+	idx_t		j;
+
+
+	run->quiet = 1;
+	runStage( run, STAGE_P1 );
+	runStage( run, STAGE_S1 );
+	run->quiet = 0;
+
+	cand = ( idx_t* )arenaAlloc( arena, ( run->n + 1 ) * sizeof( idx_t ) );
+	found = ( idx_t* )arenaAlloc( arena, ( run->n + 1 ) * sizeof( idx_t ) );
+	start = ( idx_t* )arenaAlloc( arena, ( to + 2 ) * sizeof( idx_t ) );
+	memo->p2SetSize = 1024;
+	memo->p2Set = ( int* )malloc( memo->p2SetSize * sizeof( int ) );
+	if ( !cand || !found || !start || !memo->p2Set )
+	{
+		return;
+	}
+
+
+	/*
+	   Counting sort by sum, the pairs keep
+	   their order within the same sum: the
+	   survivors of S1 are listed first, in
+	   'found', and their sums counted
+	 */
+	pairOf( run, &row, 0 );
+	for ( i = 0; i < run->n; i++ )
+	{
+		if ( ( s1[ i >> 6 ] >> ( i & 63 ) ) & 1 )
+		{
+			pairSkip( run, &row, i - row.i );
+			found[ ncand++ ] = i;
+			start[ row.sum + 1 ]++;
+		}
+	}
+
+	for ( bound = 0; bound <= to; bound++ )
+	{
+		start[ bound + 1 ] += start[ bound ];
+	}
+
+	pairOf( run, &row, 0 );
+	for ( i = 0; i < ncand; i++ )
+	{
+		pairSkip( run, &row, found[ i ] - row.i );
+		cand[ start[ row.sum ]++ ] = found[ i ];
+	}
+
+
+	for ( bound = from; bound <= to; bound++ )
+	{
+		memo->maxInt = bound - minint;
+		forgetP2S2( memo );
+
+		/*
+		   The pairs that add up to no more than
+		   the bound come first: 'start' is past
+		   the last of each sum by now
+		 */
+		j = start[ bound ];
+
+		nfound = 0;
+		for ( i = 0; i < j; i++ )
+		{
+			pairOf( run, &row, cand[ i ] );
+			bit = ( uint64_t )1 << ( row.i & 63 );
+			p2[ row.i >> 6 ] &= ~bit;
+			s2[ row.i >> 6 ] &= ~bit;
+
+			if ( !stepP2( &row, memo ) )
+			{
+				continue;
+			}
+			p2[ row.i >> 6 ] |= bit;
+
+			if ( stepS2( &row, memo ) )
+			{
+				s2[ row.i >> 6 ] |= bit;
+				found[ nfound++ ] = cand[ i ];
+			}
+		}
+
+		qsort( found, nfound, sizeof( idx_t ), cmpIdx );
+
+		outStr( &run->out, "[Begin Sums That Pass S2 for maxSum = " );
+		outInt( &run->out, bound );
+		outStr( &run->out, ":\n" );
+		for ( i = 0; i < nfound; i++ )
+		{
+			pairOf( run, &row, found[ i ] );
+			printFrRow( run, &row, &run->out );
+		}
+		outStr( &run->out, ":end Sums That Pass S2]\n" );
+	}
+}
+
+
+/*
+   Forget what was found out about P2 and
+   S2 so far
+ */
+static void
+forgetP2S2( memo_t* memo )
+{
+	int		i;
+
+
+	if ( memo->s2 )
+	{
+		memset( memo->s2, MEMO_UNKNOWN, memo->maxSum + 1 );
+	}
+
+	if ( !memo->p2 )
+	{
+		return;
+	}
+
+	if ( memo->p2Lost )
+	{
+		memset( memo->p2, MEMO_UNKNOWN, memo->maxProd + 1 );
+		memo->p2Lost = 0;
+	}
+	else
+	{
+		for ( i = 0; i < memo->nP2Set; i++ )
+		{
+			memo->p2[ memo->p2Set[ i ] ] = MEMO_UNKNOWN;
+		}
+	}
+
+	memo->nP2Set = 0;
+}
+
+
+/*
+   List the product as one whose P2
+   is remembered, see forgetP2S2()
+ */
+static void
+memoP2Set( memo_t* memo, int product )
+{
+	int*		p;
+
+
+	if ( memo->nP2Set == memo->p2SetSize )
+	{
+		p = ( int* )realloc( memo->p2Set,
+			2 * memo->p2SetSize * sizeof( int ) );
+		if ( !p )
+		{
+			memo->p2Lost = 1;
+			return;
+		}
+
+		memo->p2Set = p;
+		memo->p2SetSize *= 2;
+	}
+
+	memo->p2Set[ memo->nP2Set++ ] = product;
+}
+
+
+static int
+cmpIdx( const void* n1, const void* n2 )
+{
+	idx_t		i1 = *( const idx_t* )n1;
+	idx_t		i2 = *( const idx_t* )n2;
+
+
+	if ( i1 < i2 )
+	{
+		return -1;
+	}
+	else if ( i1 == i2 )
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+
+static uint64_t*
+init( int argc, char* argv[], arena_t* arena, int* minint, int* sumubound,
+	idx_t* n, int* nthreads, int* sweepfrom, int* verbose, int* fd, int* bench,
+	int* stats, int* survivors )
+{
+	int		opt;
+	int		sweep = 0;
+	uint64_t*	planes;
+	struct option	longOpts[] =
+	{
+		{ "sweep", no_argument, NULL, 's' },
+		{ "bench", no_argument, NULL, 'b' },
+		{ "stats", no_argument, NULL, 'S' },
+		{ "survivors", no_argument, NULL, 'p' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+
+	while ( ( opt = getopt_long( argc, argv, "j:o:v:", longOpts, NULL ) ) != -1 )
+	{
+		switch ( opt )
+		{
+		case 'o':
+			*fd = open( optarg, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+			if ( *fd < 0 )
+			{
+				return NULL;
+			}
+			break;
+
+		case 'v':
+			*verbose = atoi( optarg );
+			if ( *verbose < VERBOSE_ANSWERS || *verbose > VERBOSE_FULL )
+			{
+				return NULL;
+			}
+			break;
+
+		case 's':
+			sweep = 1;
+			break;
+
+		case 'b':
+			*bench = 1;
+			break;
+
+		case 'S':
+			*stats = 1;
+			break;
+
+		case 'p':
+			*survivors = 1;
+			break;
+
+		case 'j':
+			*nthreads = atoi( optarg );
+			if ( *nthreads < 1 )
+			{
+				return NULL;
+			}
+			break;
+
+		default:
+			return NULL;
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	if ( argc < 2 + sweep || ( sweep && *survivors ) )
+	{
+		return NULL;
+	}
+
+	*minint = atoi( argv[ 0 ] );
+	*sumubound = atoi( argv[ 1 + sweep ] );
+
+	/*
+	   The sweep works on the pairs
+	   of its largest bound
+	 */
+	if ( sweep )
+	{
+		*sweepfrom = atoi( argv[ 1 ] );
+		if ( *sweepfrom < 1 || *sweepfrom > *sumubound )
+		{
+			return NULL;
+		}
+	}
+
+
+	/*
+	   The products are 64-bit, but only up to
+	   MAX_PRODUCT; the pairs are indexed by an
+	   idx_t, which holds all of them then
+	 */
+	if ( *sumubound < 0 || ( prod_t )( *sumubound / 2 ) *
+		( *sumubound - *sumubound / 2 ) >= MAX_PRODUCT )
+	{
+		outErr( "afreudenthal", "the sum's upper bound takes the products "
+			"past 2^48", argv[ 1 + sweep ] );
+		return NULL;
+	}
+
+	if ( *minint < 1 )
+	{
+		outErr( "afreudenthal", "the numbers' lower bound is less than 1",
+			argv[ 0 ] );
+		return NULL;
+	}
+
+	*n = nPairs( *minint, *sumubound );
+	if ( *n == 0 )
+	{
+		outErr( "afreudenthal", "no pairs of numbers add up to as little "
+			"as the sum's upper bound", argv[ 1 + sweep ] );
+		return NULL;
+	}
+
+	/*
+	   The planes, the tables and the sweep's
+	   scratch all come from the one arena
+	 */
+	if ( !mkArena( arena, arenaBytes( *n, *minint, *sumubound, sweep ) ) )
+	{
+		outErr( "afreudenthal", "no room for the pairs of the sum's upper "
+			"bound", argv[ 1 + sweep ] );
+		return NULL;
+	}
+
+	planes = ( uint64_t* )arenaAlloc( arena, planeBytes( *n ) );
+	if ( !planes )
+	{
+		rmArena( arena );
+		return NULL;
+	}
+
+	return planes;
+}
+
+
+/*
+   The size of the arena: that of the planes,
+   of the tables (see mkMemo()) and, when
+   sweeping, of the sweep's scratch
+ */
+static size_t
+arenaBytes( idx_t n, int minint, int sumubound, int sweep )
+{
+	memo_t		memo;
+	size_t		size;
+
+
+	size = arenaSize( planeBytes( n ) );
+	size += sizeMemo( &memo, minint, sumubound );
+
+	if ( sweep )
+	{
+		size += 2 * arenaSize( ( ( size_t )n + 1 ) * sizeof( idx_t ) );
+		size += arenaSize( ( ( size_t )sumubound + 2 ) * sizeof( idx_t ) );
+	}
+
+	return size;
+}
+
+
+/*
+   The bit planes of 'n' pairs, all
+   N_STAGES of them, one after another
+ */
+static size_t
+planeBytes( idx_t n )
+{
+	return N_STAGES * ( ( size_t )n / 64 + 1 ) * sizeof( uint64_t );
+}
+
+
+/*
+   The run goes through the 'n' pairs of the
+   bounds, their planes laid out in 'planes'
+   by planeBytes(). The pairs are split into a
+   few shards per thread, to even out the load;
+   the output goes to 'fd'
+
+   Returns NULL if the threads or the buffers
+   can not be had, 'run' otherwise
+ */
+static run_t*
+mkRun( run_t* run, uint64_t* planes, idx_t n, int minint, int sumubound,
+	memo_t* memo, int nthreads, int fd )
+{
+	int		i;
+
+
+	memset( run, 0, sizeof( run_t ) );
+
+	for ( i = 0; i < N_STAGES; i++ )
+	{
+		run->passed[ i ] = planes + i * ( ( size_t )n / 64 + 1 );
+	}
+	run->n = n;
+	run->minInt = minint;
+	run->maxSum = sumubound;
+	run->memo = memo;
+	run->verbose = VERBOSE_FULL;
+
+	if ( !mkOut( &run->out, fd ) )
+	{
+		rmOut( &run->out );
+		return NULL;
+	}
+
+	if ( !mkPool( &run->pool, nthreads ) )
+	{
+		rmOut( &run->out );
+		return NULL;
+	}
+
+	if ( run->pool.nThreads <= 1 )
+	{
+		return run;
+	}
+
+	run->nShards = run->pool.nThreads * 8;
+	run->bufs = ( out_t* )calloc( run->nShards, sizeof( out_t ) );
+	run->nPassed = ( idx_t* )calloc( run->nShards, sizeof( idx_t ) );
+	if ( !run->bufs || !run->nPassed )
+	{
+		rmRun( run );
+		return NULL;
+	}
+
+	/*
+	   The shards' buffers keep it all
+	   and grow on their first use
+	 */
+	for ( i = 0; i < run->nShards; i++ )
+	{
+		run->bufs[ i ].fd = -1;
+	}
+
+	return run;
+}
+
+
+/*
+   Returns 0, -1 if the output
+   could not be written out
+ */
+static int
+rmRun( run_t* run )
+{
+	int		i;
+
+
+	for ( i = 0; run->bufs && i < run->nShards; i++ )
+	{
+		rmOut( &run->bufs[ i ] );
+	}
+
+	if ( run->bufs )
+	{
+		free( run->bufs );
+	}
+
+	if ( run->nPassed )
+	{
+		free( run->nPassed );
+	}
+
+	rmPool( &run->pool );
+
+	return rmOut( &run->out );
+}
+
+
+/*
+   Fill the memo's 'goldbach': the number of ways
+   each sum up to 'maxSum' goes as p + q, p <= q
+   both prime, on the run's threads
+
+   An odd sum has but 2 + ( sum - 2 ). An even one
+   is 2i + 1 + 2j + 1, i + j = sum / 2 - 1, which
+   are the bits 'i' and 'j' of the sieve's 'odd':
+   laid out reversed in 'rev', the bits 'j' line up
+   with the bits 'i', a word at a time, and the
+   count is the popcount of the two ANDed
+
+   The table is dropped if 'rev' can not be had,
+   for S1 to be evaluated every time instead
+ */
+static void
+mkGoldbach( run_t* run )
+{
+	memo_t*		memo = run->memo;
+	uint64_t*	odd = memo->sieve->odd;
+	int		i;
+	int		j;
+
+
+	if ( !memo->goldbach )
+	{
+		return;
+	}
+
+	/*
+	   'rev' gets two words more than it holds,
+	   read past its end by nGoldbach()
+	 */
+	memo->nRev = memo->maxSum / 2;
+	memo->rev = ( uint64_t* )calloc( memo->nRev / 64 + 3, sizeof( uint64_t ) );
+	if ( !memo->rev )
+	{
+		memo->goldbach = NULL;
+		return;
+	}
+
+	for ( i = 0; i < memo->nRev; i++ )
+	{
+		j = memo->nRev - 1 - i;
+		if ( ( odd[ j >> 6 ] >> ( j & 63 ) ) & 1 )
+		{
+			memo->rev[ i >> 6 ] |= ( uint64_t )1 << ( i & 63 );
+		}
+	}
+
+	runPool( &run->pool, mkGoldbachIn, memo, memo->maxSum + 1 );
+
+	free( memo->rev );
+	memo->rev = NULL;
+}
+
+
+/*
+   mkGoldbach() of the sums 'lo'
+   through 'hi' - 1
+ */
+static void
+mkGoldbachIn( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	memo_t*		memo = ( memo_t* )arg;
+	int		sum;
+
+
+	( void )thread;
+
+	for ( sum = lo; sum < hi; sum++ )
+	{
+		if ( sum < 4 )
+		{
+			memo->goldbach[ sum ] = 0;
+		}
+		else if ( sum & 1 )
+		{
+			memo->goldbach[ sum ] = isPrime( memo->sieve, sum - 2 );
+		}
+		else if ( sum == 4 )
+		{
+			memo->goldbach[ sum ] = 1;
+		}
+		else
+		{
+			memo->goldbach[ sum ] = nGoldbach( memo, sum / 2 - 1 );
+		}
+	}
+}
+
+
+/*
+   The number of 'i' up to 't' / 2 that have
+   both the bits 'i' and 't' - 'i' set in the
+   sieve's 'odd': the latter is the bit 'nRev'
+   - 1 - 't' + 'i' of 'rev', so that the bits
+   of 'rev' from 'nRev' - 1 - 't' on are ANDed
+   with those of 'odd' from 0 on
+ */
+static int
+nGoldbach( memo_t* memo, int t )
+{
+	uint64_t*	odd = memo->sieve->odd;
+	uint64_t*	rev = memo->rev;
+	uint64_t	word;
+	int		n = t / 2 + 1; /* is the number of the bits */
+	int		off = memo->nRev - 1 - t;
+	int		q = off >> 6;
+	int		r = off & 63;
+	int		w;
+	int		cnt = 0;
+
+
+	for ( w = 0; w * 64 < n; w++ )
+	{
+		word = rev[ q + w ] >> r;
+		if ( r )
+		{
+			word |= rev[ q + w + 1 ] << ( 64 - r );
+		}
+
+		word &= odd[ w ];
+		if ( n - w * 64 < 64 )
+		{
+			word &= ( ( uint64_t )1 << ( n - w * 64 ) ) - 1;
+		}
+
+		cnt += __builtin_popcountll( word );
+	}
+
+	return cnt;
+}
+
+
+/*
+   Fill the memo's 'semiprimes': the products
+   up to 'maxProd' of two primes up to 'maxInt',
+   by markSemiprimes(), a range of the table's
+   words per chunk of the run's threads
+ */
+static void
+mkSemiprimes( run_t* run )
+{
+	memo_t*		memo = run->memo;
+
+
+	if ( !memo->semiprimes )
+	{
+		return;
+	}
+
+	runPool( &run->pool, mkSemiprimesIn, memo,
+		( int )( memo->maxProd / 64 + 1 ) );
+}
+
+
+static void
+mkSemiprimesIn( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	memo_t*		memo = ( memo_t* )arg;
+
+
+	( void )thread;
+
+	markSemiprimes( memo->sieve, memo->maxInt, memo->semiprimes, lo, hi );
+}
+
+
+/*
+   The sums looked up go as high as two
+   largest numbers added together (P2
+   adds up the factors of the products),
+   the products - as high as the largest
+   product of two terms of a legal sum
+
+   The tables come from 'arena'; one that
+   can not be had is left NULL, its values
+   get evaluated every time they are needed,
+   as are the P1's and P2's of the products
+   past an int. The sieve is the only thing
+   that can not do without
+
+   The products are always factored by
+   their factors, so the primes are sieved,
+   along with the smallest prime factors,
+   only as high as the sums go
+ */
+static memo_t*
+mkMemo( memo_t* memo, sieve_t* sieve, arena_t* arena, int minint,
+	int sumubound )
+{
+	sizeMemo( memo, minint, sumubound );
+
+	memo->sieve = mkSieve( sieve, memo->maxSum, 1 );
+	if ( !memo->sieve )
+	{
+		return NULL;
+	}
+
+	memo->goldbach = ( int* )arenaAlloc( arena,
+		( ( size_t )memo->maxSum + 1 ) * sizeof( int ) );
+	memo->s2 = ( signed char* )arenaAlloc( arena, memo->maxSum + 1 );
+	if ( memo->maxProd < INT_MAX )
+	{
+		memo->semiprimes = ( uint64_t* )arenaAlloc( arena,
+			( ( size_t )memo->maxProd / 64 + 1 ) * sizeof( uint64_t ) );
+		memo->p2 = ( signed char* )arenaAlloc( arena, memo->maxProd + 1 );
+	}
+
+	return memo;
+}
+
+
+/*
+   Sets the bounds of the tables, returns
+   the room they take in the arena
+ */
+static size_t
+sizeMemo( memo_t* memo, int minint, int sumubound )
+{
+	prod_t		half = sumubound / 2;
+	size_t		size;
+
+
+	memset( memo, 0, sizeof( memo_t ) );
+
+	memo->minInt = minint;
+	memo->maxInt = sumubound - minint;
+
+	memo->maxSum = memo->maxInt + memo->maxInt;
+	if ( memo->maxSum < sumubound )
+	{
+		memo->maxSum = sumubound;
+	}
+
+	memo->maxProd = half * ( sumubound - half );
+
+	size = arenaSize( ( ( size_t )memo->maxSum + 1 ) * sizeof( int ) );
+	size += arenaSize( ( size_t )memo->maxSum + 1 );
+	if ( memo->maxProd < INT_MAX )
+	{
+		size += arenaSize( ( ( size_t )memo->maxProd / 64 + 1 ) *
+			sizeof( uint64_t ) );
+		size += arenaSize( ( size_t )memo->maxProd + 1 );
+	}
+
+	return size;
+}
+
+
+static void
+rmMemo( memo_t* memo )
+{
+	if ( memo->sieve )
+	{
+		rmSieve( memo->sieve );
+	}
+
+	if ( memo->p2Set )
+	{
+		free( memo->p2Set );
+	}
+}
+
+
+/*
+   Print the pair into 'out', along with
+   what it has passed so far
+ */
+static void
+printFrRow( run_t* run, fr_t* row, out_t* out )
+{
+	outInt( out, row->x );
+	outChar( out, ' ' );
+	outInt( out, row->y );
+	outChar( out, '\t' );
+	outInt( out, row->sum );
+	outChar( out, '\t' );
+	outInt( out, row->prod );
+	outStr( out, "\tprodpp1 = " );
+	outInt( out, passed( run, STAGE_P1, row->i ) );
+	outStr( out, "\t\t sumps1 = " );
+	outInt( out, passed( run, STAGE_S1, row->i ) );
+	outStr( out, "\tprodp2 = " );
+	outInt( out, passed( run, STAGE_P2, row->i ) );
+	outStr( out, "\tsumps2 = " );
+	outInt( out, passed( run, STAGE_S2, row->i ) );
+	outChar( out, '\n' );
+}
+
+
+static void
+printFr( run_t* run )
+{
+	fr_t		row;
+	idx_t		i;
+
+
+	if ( run->verbose == VERBOSE_COUNTS )
+	{
+		outStr( &run->out, "Freudenthal pairs: " );
+		outInt( &run->out, run->n );
+		outChar( &run->out, '\n' );
+	}
+
+	if ( run->verbose < VERBOSE_FULL )
+	{
+		return;
+	}
+
+	outStr( &run->out, "Total of " );
+	outInt( &run->out, run->n );
+	outStr( &run->out, " Freudenthal pairs:\n" );
+	pairOf( run, &row, 0 );
+	for ( i = 0; i < run->n; i++ )
+	{
+		pairSkip( run, &row, i - row.i );
+		printFrRow( run, &row, &run->out );
+	}
+}
+
+
+/*
+   Print the pairs that survive each of the
+   statements, as "P1 x y" and so on, those
+   of a statement after another
+ */
+static void
+printSurvivors( run_t* run )
+{
+	idx_t		i;
+	int		stage;
+	fr_t		row;
+	const char*	names[ N_STAGES ] = { "P1", "S1", "P2", "S2" };
+
+
+	for ( stage = 0; stage < N_STAGES; stage++ )
+	{
+		pairOf( run, &row, 0 );
+		for ( i = 0; i < run->n; i++ )
+		{
+			if ( !passed( run, stage, i ) )
+			{
+				continue;
+			}
+
+			pairSkip( run, &row, i - row.i );
+			outStr( &run->out, names[ stage ] );
+			outChar( &run->out, ' ' );
+			outInt( &run->out, row.x );
+			outChar( &run->out, ' ' );
+			outInt( &run->out, row.y );
+			outChar( &run->out, '\n' );
+		}
 	}
 }
@@ -0,0 +1,75 @@
+#include <string.h>
+#include <sys/mman.h>
+
+#include "arena.h"
+
+
+/*
+   The size past which the
+   huge pages are asked for
+ */
+#define ARENA_HUGE		( ( size_t )1 << 21 )
+
+
+/*
+   Returns NULL if the region
+   can not be had, 'arena' otherwise
+ */
+extern arena_t*
+mkArena( arena_t* arena, size_t size )
+{
+	memset( arena, 0, sizeof( arena_t ) );
+
+	arena->size = size > 0 ? size : ARENA_ALIGN;
+	arena->base = ( char* )mmap( NULL, arena->size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if ( arena->base == MAP_FAILED )
+	{
+		memset( arena, 0, sizeof( arena_t ) );
+		return NULL;
+	}
+
+#ifdef MADV_HUGEPAGE
+	if ( arena->size >= ARENA_HUGE )
+	{
+		madvise( arena->base, arena->size, MADV_HUGEPAGE );
+	}
+#endif
+
+	return arena;
+}
+
+
+extern void
+rmArena( arena_t* arena )
+{
+	if ( arena->base )
+	{
+		munmap( arena->base, arena->size );
+	}
+
+	memset( arena, 0, sizeof( arena_t ) );
+}
+
+
+/*
+   Returns 'size' bytes of the region, all
+   zeros, NULL if it has no room for them
+ */
+extern void*
+arenaAlloc( arena_t* arena, size_t size )
+{
+	void*		p;
+
+
+	size = arenaSize( size );
+	if ( size > arena->size - arena->used )
+	{
+		return NULL;
+	}
+
+	p = arena->base + arena->used;
+	arena->used += size;
+
+	return p;
+}
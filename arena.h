@@ -0,0 +1,45 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+
+/*
+   All of a solver's state in one region of
+   memory, shared by both solvers
+
+   The region is mapped once, of the size the
+   solver works out up front, and handed out
+   piece by piece; its pages are all zeros and
+   are only had once touched, yet a region the
+   system can not back is refused right away,
+   as malloc() would be. Large regions are asked
+   for huge pages. Nothing is freed on its own:
+   rmArena() unmaps it all at once
+
+   A solver adds up arenaSize() of each piece
+   to get the size of the region
+ */
+#define ARENA_ALIGN		64
+
+typedef struct
+{
+	char*		base;
+	size_t		size;
+	size_t		used;
+} arena_t;
+
+
+extern arena_t*		mkArena( arena_t*, size_t );
+extern void		rmArena( arena_t* );
+extern void*		arenaAlloc( arena_t*, size_t );
+
+
+static inline size_t
+arenaSize( size_t n )
+{
+	return ( n + ARENA_ALIGN - 1 ) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+
+#endif
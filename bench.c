@@ -0,0 +1,323 @@
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+#include "bench.h"
+
+
+long long		benchCounts[ BENCH_COUNTERS ];
+
+
+static long long	nowNs( void );
+static long long	nowCycles( void );
+static void		outSeconds( out_t*, long long );
+static void		outPad( out_t*, const char*, int );
+
+
+extern void
+mkBench( bench_t* bench, const char* solver )
+{
+	memset( bench, 0, sizeof( bench_t ) );
+
+	bench->solver = solver;
+	bench->start = nowNs();
+	bench->mark = bench->start;
+	bench->cycleMark = nowCycles();
+}
+
+
+/*
+   Name the first 'n' counters, up to
+   BENCH_COUNTERS of them
+ */
+extern void
+benchCounters( bench_t* bench, const char* const* names, int n )
+{
+	bench->counters = names;
+	bench->nCounters = n < BENCH_COUNTERS ? n : BENCH_COUNTERS;
+}
+
+
+/*
+   Charge the time since the last mark to the
+   phase 'name', past the first BENCH_PHASES
+   names the time is not kept
+ */
+extern void
+benchPhase( bench_t* bench, const char* name )
+{
+	long long	now = nowNs();
+	long long	cycles = nowCycles();
+	long long	count;
+	int		i;
+	int		c;
+
+
+	for ( i = 0; i < bench->nPhases; i++ )
+	{
+		if ( !strcmp( bench->phases[ i ].name, name ) )
+		{
+			break;
+		}
+	}
+
+	if ( i == bench->nPhases && bench->nPhases < BENCH_PHASES )
+	{
+		memset( &bench->phases[ i ], 0, sizeof( benchPhase_t ) );
+		bench->phases[ i ].name = name;
+		bench->nPhases++;
+	}
+
+	for ( c = 0; c < bench->nCounters; c++ )
+	{
+		count = __atomic_load_n( &benchCounts[ c ], __ATOMIC_RELAXED );
+		if ( i < bench->nPhases )
+		{
+			bench->phases[ i ].counts[ c ] += count - bench->countMarks[ c ];
+		}
+		bench->countMarks[ c ] = count;
+	}
+
+	if ( i < bench->nPhases )
+	{
+		bench->phases[ i ].ns += now - bench->mark;
+		bench->phases[ i ].cycles += cycles - bench->cycleMark;
+	}
+
+	bench->mark = now;
+	bench->cycleMark = cycles;
+}
+
+
+/*
+   The phase and counter names are the
+   solvers' own, they need no escaping
+ */
+extern void
+benchReport( bench_t* bench, out_t* out )
+{
+	struct rusage	ru;
+	long long	ns = nowNs() - bench->start;
+	int		i;
+	int		c;
+
+
+	memset( &ru, 0, sizeof( ru ) );
+	getrusage( RUSAGE_SELF, &ru );
+
+	outStr( out, "{\"solver\":\"" );
+	outStr( out, bench->solver );
+	outStr( out, "\",\"minInt\":" );
+	outInt( out, bench->minInt );
+	outStr( out, ",\"maxSum\":" );
+	outInt( out, bench->maxSum );
+	outStr( out, ",\"threads\":" );
+	outInt( out, bench->nThreads );
+	outStr( out, ",\"pairs\":" );
+	outInt( out, bench->nPairs );
+	outStr( out, ",\"pairsPerSec\":" );
+	outInt( out, ns > 0 ? ( long long )( ( double )bench->nPairs * 1e9 / ns ) : 0 );
+	outStr( out, ",\"maxRssKiB\":" );
+	outInt( out, ru.ru_maxrss );
+	outStr( out, ",\"wall\":" );
+	outSeconds( out, ns );
+
+	outStr( out, ",\"phases\":{" );
+	for ( i = 0; i < bench->nPhases; i++ )
+	{
+		outStr( out, i > 0 ? ",\"" : "\"" );
+		outStr( out, bench->phases[ i ].name );
+		outStr( out, "\":" );
+		outSeconds( out, bench->phases[ i ].ns );
+	}
+	outChar( out, '}' );
+
+	/*
+	   The counters, those of every
+	   phase and their totals
+	 */
+	if ( bench->nCounters > 0 )
+	{
+		outStr( out, ",\"cycles\":{" );
+		for ( i = 0; i < bench->nPhases; i++ )
+		{
+			outStr( out, i > 0 ? ",\"" : "\"" );
+			outStr( out, bench->phases[ i ].name );
+			outStr( out, "\":" );
+			outInt( out, bench->phases[ i ].cycles );
+		}
+
+		outStr( out, "},\"counters\":{" );
+		for ( i = 0; i < bench->nPhases; i++ )
+		{
+			outStr( out, i > 0 ? ",\"" : "\"" );
+			outStr( out, bench->phases[ i ].name );
+			outStr( out, "\":{" );
+			for ( c = 0; c < bench->nCounters; c++ )
+			{
+				outStr( out, c > 0 ? ",\"" : "\"" );
+				outStr( out, bench->counters[ c ] );
+				outStr( out, "\":" );
+				outInt( out, bench->phases[ i ].counts[ c ] );
+			}
+			outChar( out, '}' );
+		}
+
+		outStr( out, "},\"totals\":{" );
+		for ( c = 0; c < bench->nCounters; c++ )
+		{
+			outStr( out, c > 0 ? ",\"" : "\"" );
+			outStr( out, bench->counters[ c ] );
+			outStr( out, "\":" );
+			outInt( out, benchCounts[ c ] );
+		}
+		outChar( out, '}' );
+	}
+
+	outStr( out, "}\n" );
+}
+
+
+/*
+   benchReport() for the eye: a line per
+   phase, then a line per counter with its
+   count in every phase
+ */
+extern void
+benchSummary( bench_t* bench, out_t* out )
+{
+	struct rusage	ru;
+	long long	ns = nowNs() - bench->start;
+	int		i;
+	int		c;
+	const char*	sep;
+
+
+	memset( &ru, 0, sizeof( ru ) );
+	getrusage( RUSAGE_SELF, &ru );
+
+	outStr( out, bench->solver );
+	outChar( out, ' ' );
+	outInt( out, bench->minInt );
+	outChar( out, ' ' );
+	outInt( out, bench->maxSum );
+	outStr( out, ": " );
+	outInt( out, bench->nPairs );
+	outStr( out, " pairs, " );
+	outInt( out, bench->nThreads );
+	outStr( out, " thread(s), " );
+	outSeconds( out, ns );
+	outStr( out, " s, " );
+	outInt( out, ru.ru_maxrss );
+	outStr( out, " KiB peak RSS\n" );
+
+	for ( i = 0; i < bench->nPhases; i++ )
+	{
+		outPad( out, bench->phases[ i ].name, 20 );
+		outSeconds( out, bench->phases[ i ].ns );
+		outStr( out, " s" );
+		if ( bench->nCounters > 0 )
+		{
+			outStr( out, ", " );
+			outInt( out, bench->phases[ i ].cycles );
+			outStr( out, " cycles" );
+		}
+		outChar( out, '\n' );
+	}
+
+	for ( c = 0; c < bench->nCounters; c++ )
+	{
+		outPad( out, bench->counters[ c ], 20 );
+		outInt( out, benchCounts[ c ] );
+		sep = " = ";
+		for ( i = 0; i < bench->nPhases; i++ )
+		{
+			if ( bench->phases[ i ].counts[ c ] == 0 )
+			{
+				continue;
+			}
+
+			outStr( out, sep );
+			sep = ", ";
+			outStr( out, bench->phases[ i ].name );
+			outChar( out, ' ' );
+			outInt( out, bench->phases[ i ].counts[ c ] );
+		}
+		outChar( out, '\n' );
+	}
+}
+
+
+static long long
+nowNs( void )
+{
+	struct timespec	ts;
+
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return ( long long )ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+/*
+   Returns 0 where there is no
+   counter to be read
+ */
+static long long
+nowCycles( void )
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+	return ( long long )__rdtsc();
+#else
+	return 0;
+#endif
+}
+
+
+/*
+   'ns' as seconds, down
+   to the microsecond
+ */
+static void
+outSeconds( out_t* out, long long ns )
+{
+	long long	us = ns / 1000;
+	char		frac[ 6 ];
+	int		i;
+
+
+	outInt( out, us / 1000000 );
+
+	for ( i = 5; i >= 0; i-- )
+	{
+		frac[ i ] = '0' + us % 10;
+		us /= 10;
+	}
+
+	outChar( out, '.' );
+	outBytes( out, frac, 6 );
+}
+
+
+/*
+   'label' and a colon, padded
+   with spaces to 'width'
+ */
+static void
+outPad( out_t* out, const char* label, int width )
+{
+	int		n = strlen( label ) + 1;
+
+
+	outStr( out, label );
+	outChar( out, ':' );
+	for ( ; n < width; n++ )
+	{
+		outChar( out, ' ' );
+	}
+}
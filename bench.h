@@ -0,0 +1,82 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "out.h"
+
+
+/*
+   Timing of a solver's run, phase by phase,
+   shared by both solvers
+
+   The run is cut into named phases: benchPhase()
+   closes the one under way, charging the time
+   since the previous call to the name given - a
+   name that comes up again adds up. The clock is
+   read only then, a handful of times a run, the
+   timing is always there to be had
+
+   benchReport() prints the run as a single line
+   of JSON: the solver, its bounds and threads,
+   the number of pairs of numbers it has gone
+   through and how many of them a second, the
+   wall time of each phase and of the whole run,
+   and the peak resident set size; benchSummary()
+   prints the same as a table
+
+   Built with -DFR_STATS the solvers count what
+   they do as well, into 'benchCounts': BENCH_COUNT()
+   of a counter is compiled out otherwise. The
+   counters a solver has are named by benchCounters(),
+   each phase is charged with what they have counted
+   since the previous one, along with the cycles
+   (the time stamp counter, on x86), and both are
+   reported per phase
+ */
+#define BENCH_PHASES		16
+#define BENCH_COUNTERS		16
+
+extern long long	benchCounts[ BENCH_COUNTERS ];
+
+#ifdef FR_STATS
+#define BENCH_COUNT( id, n ) \
+	__atomic_fetch_add( &benchCounts[ id ], ( n ), __ATOMIC_RELAXED )
+#else
+#define BENCH_COUNT( id, n )	( ( void )0 )
+#endif
+
+typedef struct
+{
+	const char*	name;
+	long long	ns;
+	long long	cycles;
+	long long	counts[ BENCH_COUNTERS ];
+} benchPhase_t;
+
+typedef struct
+{
+	const char*	solver;
+	int		minInt;
+	int		maxSum;
+	int		nThreads;
+	long long	nPairs;
+
+	long long	start; /* of the run, in ns */
+	long long	mark; /* of the phase under way */
+	long long	cycleMark;
+	long long	countMarks[ BENCH_COUNTERS ];
+	int		nPhases;
+	benchPhase_t	phases[ BENCH_PHASES ];
+
+	const char* const*	counters; /* names, none without FR_STATS */
+	int		nCounters;
+} bench_t;
+
+
+extern void		mkBench( bench_t*, const char* );
+extern void		benchCounters( bench_t*, const char* const*, int );
+extern void		benchPhase( bench_t*, const char* );
+extern void		benchReport( bench_t*, out_t* );
+extern void		benchSummary( bench_t*, out_t* );
+
+
+#endif
@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+#  Benchmark both solvers across a ladder of the
+#  sum's upper bounds: builds them, runs each one
+#  on every bound with --bench and prints one line
+#  of JSON per run (see bench.h), a run that fails,
+#  typically for lack of memory, as
+#     {"solver":...,"maxSum":...,"failed":true}
+#
+#  The output is meant to be kept and compared:
+#     ./bench.sh > before.json
+#     ./bench.sh > after.json
+#
+#  The environment tunes it:
+#     SUMS       the ladder, 100 through 10^6 by default
+#     MININT     the numbers' lower bound, 2 by default
+#     THREADS    the threads (-j) of every run, 1 by default
+#     SOLVERS    the solvers to run, both by default
+#     OPTS       more options for every run, say -d
+#     CC, CFLAGS the compiler and its flags, -DFR_STATS
+#                among them adds the counters to every line
+#
+
+SUMS=${SUMS:-"100 1000 10000 100000 1000000"}
+MININT=${MININT:-2}
+THREADS=${THREADS:-1}
+SOLVERS=${SOLVERS:-"cfreudenthal afreudenthal"}
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:-"-O2"}
+
+cd "$(dirname "$0")" || exit 1
+
+BIN=$(mktemp -d) || exit 1
+trap 'rm -rf "$BIN"' EXIT
+
+$CC $CFLAGS -o "$BIN/cfreudenthal" cfreudenthal.c primes.c pool.c out.c \
+	snap.c store.c bench.c arena.c nummap.c -lm -lpthread || exit 1
+$CC $CFLAGS -o "$BIN/afreudenthal" afreudenthal.c primes.c pool.c out.c \
+	bench.c arena.c -lm -lpthread || exit 1
+
+for sum in $SUMS
+do
+	for solver in $SOLVERS
+	do
+		# shellcheck disable=SC2086
+		line=$("$BIN/$solver" --bench -v 0 -o /dev/null -j "$THREADS" \
+			$OPTS "$MININT" "$sum" 2>&1 >/dev/null | tail -n 1)
+
+		case "$line" in
+		"{"*)
+			echo "$line"
+			;;
+		*)
+			echo "{\"solver\":\"$solver\",\"maxSum\":$sum,\"failed\":true}"
+			;;
+		esac
+	done
+done
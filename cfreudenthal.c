@@ -1,7 +1,24 @@
-#include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+
+#if defined( __AVX2__ ) || defined( __AVX512F__ )
+#include <immintrin.h>
+#endif
+
+#include "primes.h"
+#include "pool.h"
+#include "out.h"
+#include "snap.h"
+#include "store.h"
+#include "bench.h"
+#include "arena.h"
+#include "pairs.h"
+#include "nummap.h"
 
 
 /*
@@ -42,6 +59,74 @@
 
    argv[ 2 ] is the sum's upper bound
 
+   Both may be preceded by the options:
+
+   -d keeps the matrix dense, bit-packed, rather than
+   sparse: worth it while the bounds are small enough
+   for the whole matrix to sit in the cache
+
+   -j N runs the rounds of elimination on N threads
+
+   -v N prints the answer(s) alone (0), the number of
+   survivors of every round along with them (1) or the
+   survivors themselves (2, the default)
+
+   -o FILE prints into FILE rather than onto stdout
+
+   -s PREFIX writes a binary snapshot of the matrix as it
+   stands before each round of elimination, and before the
+   answer(s), into PREFIX.0, PREFIX.1 and so on, one per
+   statement of the dialog
+
+   -m FILE keeps the adjacency of the sparse matrix in the
+   scratch file FILE, mapped into memory, rather than on
+   the heap: for the bounds where it does not fit in the
+   memory, the rounds of elimination walk it in its order
+
+   -r FILE resumes from such a snapshot instead of building
+   the matrix, the bounds are those of the snapshot and are
+   not to be given:
+      ./cfreudenthal -s /tmp/fr 2 99
+      ./cfreudenthal -r /tmp/fr.2
+
+   --sweep takes three numbers: the numbers' lower bound
+   and a range of the sum's upper bounds, all of which
+   are solved in one go, printing the answer(s) alone
+   for each one of them:
+      ./cfreudenthal --sweep 2 99 1000
+
+   --bench reports the wall time of each phase of the
+   run onto stderr, as a line of JSON, see bench.h:
+      ./cfreudenthal --bench -v 0 -o /dev/null 2 10000
+
+   --stats reports the same as a table, built with
+   -DFR_STATS both report the counters below as well
+
+   --survivors prints, instead of the above, the pairs
+   of numbers that survive each of P1, S1, P2 and S2,
+   a pair a line, for crosscheck.sh to compare with
+   those of afreudenthal:
+      P1 x y
+
+   --dialog replaces the above dialog with another one,
+   a statement per word: the speaker, P or S, and what
+   is said - "no" for "I do not know", "yes" for "I
+   know" or "knew" for "I knew that", of the other's
+   statement just before. A word, or a group of them
+   in parentheses, is repeated N times by a *N after
+   it; the above dialog is
+      ./cfreudenthal --dialog "P:no S:knew P:yes S:yes" 2 99
+   and another one may well be
+      ./cfreudenthal --dialog "(P:no S:no)*3 P:yes" 2 99
+
+   A * with no N after it repeats the word or the group
+   until a round of it takes nothing out, a fixed point:
+      ./cfreudenthal --dialog "(P:no S:no)* P:yes" 2 99
+
+   The rounds only look again at the sums and the products
+   that lost some of theirs since they were last looked at,
+   so that a long dialog costs about as much as it takes out
+
    The program's input is inclusive - all the tests to
    generate the relevant sets of numbers are
    "greater/less than or equal to"
@@ -50,6 +135,14 @@
    is:
       ./cfreudenthal 2 99
 
+   The program is built along with the shared primality
+   engine, thread pool and output:
+      cc -O2 -o cfreudenthal cfreudenthal.c primes.c pool.c out.c \
+         snap.c store.c bench.c arena.c nummap.c -lm -lpthread
+
+   add -march=native to let the dense matrix count its
+   bits with the AVX2 or AVX-512 instructions
+
    The program outputs the corresponding product/sum
    survivors of the consecutive rounds of elimination
    followed by the final answer(s)
@@ -58,18 +151,75 @@
 
 
 /*
-   A malloc()ed array of num_t's where 'num'
-   is a sum forms matrix's columns' header
+   An array of num_t's where 'num' is a
+   sum forms matrix's columns' header
+
+   An array of num_t's where 'num' is a
+   product forms matrix's rows' header
 
-   A malloc()ed array of num_t's where 'num'
-   is a product forms matrix's rows' header
+   'nLive' of a column is the number of live
+   products (rows) that have this sum, 'nLive'
+   of a row is the number of live sums (columns)
+   that this product has. Both are kept up to
+   date as the rows and columns are eliminated
+
+   The products are 64-bit, so are the sums
+   along with them
  */
 typedef struct
 {
-	int		num;
+	prod_t		num;
 	char		live; /* meaning: not eliminated */
+	int		nLive; /* live cells in this row/column */
 } num_t;
 
+
+/*
+   A dialog is a list of statements, each one
+   made by P (of the products, the rows) or S
+   (of the sums, the columns) and compiled into
+   a round of elimination by runSay()
+
+   "I do not know" leaves the speaker's numbers
+   with more than one live number of the other
+   kind, "I know" - with exactly one. "I knew
+   that" leaves the speaker's numbers none of
+   whose live numbers of the other kind fails
+   the other's statement just before; that
+   statement needs no round of its own then -
+   the numbers that fail it lose all of their
+   live cells and are out of the picture - and
+   is marked 'fused'
+
+   A run of statements may be a fixed point,
+   made over and over until a round of it takes
+   no live cell out: its first and last ones are
+   marked in 'loop'. Once the last one is made,
+   the run is repeated right after it, see
+   repeatSays(), for as long as it takes and
+   the dialog has room for
+ */
+#define CLAIM_NO		0
+#define CLAIM_YES		1
+#define CLAIM_KNEW		2
+
+#define LOOP_FIRST		1
+#define LOOP_LAST		2
+
+#define MAX_SAYS		1024
+
+typedef struct
+{
+	char		speaker; /* 'P' or 'S' */
+	char		claim; /* is one of CLAIM_* */
+	char		fused;
+	char		loop; /* LOOP_* */
+	char		changed; /* its round took a live cell out */
+	char		name[ 8 ]; /* P1, S1, P2 ... */
+	const char*	phrase;
+} say_t;
+
+
 typedef struct
 {
 	int		minInt;
@@ -78,34 +228,309 @@ typedef struct
 	int		maxSum;
 
 	int		nCols; /* is the number of legal sums */
-	int		nRows; /* is the number of legal products */
+	idx_t		nRows; /* is the number of legal products */
 	num_t*		cols; /* array of legal sums, see above */
 	num_t*		rows; /* array of legal products, see above */
 
 	/*
-	   Dynamically allocated 2D array of binary values:
-	   1 - means that the factors of this product add to this sum
-	   0 - means no correlation between this product and this sum
+	   The columns of the sums and the rows of
+	   the products by value, see nummap.h: the
+	   products' is had while the matrix is built
+	 */
+	nummap_t	sumMap;
+	nummap_t	prodMap;
+
+	/*
+	   Sparse 2D array of binary values: only the cells
+	   where the factors of a product add to a sum are
+	   stored, the rest are implied 0's
+
+	   Row-major (CSR) adjacency: the sums (columns) of
+	   the product 'row' are rowCols[ rowStart[ row ] ]
+	   through rowCols[ rowStart[ row + 1 ] - 1 ], in the
+	   ascending order
+
+	   Column-major (CSC) adjacency: the products (rows)
+	   of the sum 'col' are colRows[ colStart[ col ] ]
+	   through colRows[ colStart[ col + 1 ] - 1 ], in the
+	   ascending order
+	 */
+	idx_t		nCells; /* is the number of 1's in the matrix */
+	idx_t		cellRoom; /* is the most there can be */
+	idx_t*		rowStart; /* nRows + 1 offsets into rowCols */
+	int*		rowCols; /* nCells column indices */
+	idx_t*		colStart; /* nCols + 1 offsets into colRows */
+	idx_t*		colRows; /* nCells row indices */
+
+	/*
+	   Dense mode: the same 2D array bit-packed,
+	   a row of 'nColWords' 64-bit words per
+	   product in 'bits', and its transpose, a
+	   row of 'nRowWords' words per sum in 'tbits'
+
+	   'liveCols' and 'liveRows' mirror the 'live'
+	   flags of the columns and the rows as bitmasks,
+	   which turns counting the live cells of a row
+	   or a column into an AND and a popcount
+
+	   The sparse arrays above are not used then,
+	   nor are the 'nLive' counts. The bitmasks of
+	   the columns and of the rows below take as
+	   many words in either mode
+	 */
+	char		dense;
+	int		nColWords;
+	idx_t		nRowWords;
+	uint64_t*	bits;
+	uint64_t*	tbits;
+	uint64_t*	liveCols;
+	uint64_t*	liveRows;
+
+	sieve_t		sieve; /* factors the products */
+
+	/*
+	   Runs the rounds of elimination, the rows
+	   or the columns are split among its threads
+	 */
+	int		nThreads;
+	pool_t		pool;
+
+	/*
+	   The columns, or the rows, that a round of
+	   "I knew that" is to eliminate, as marked
+	   by the others: a bitmask with room for
+	   either
+	 */
+	uint64_t*	doomed;
+
+	/*
+	   The worklist: every live row fits the claim
+	   'rowClaim' - it was last checked against -
+	   but for those that have no live sum left and
+	   the neighbours of the columns eliminated
+	   since, marked in 'goneCols'; it is -1 until
+	   a round checks the rows. A round that checks
+	   them against the same claim only visits those
+	   neighbours, marked in 'dirtyRows' first, so
+	   that a long dialog costs about as much as it
+	   takes out. 'colClaim', 'goneRows' and
+	   'dirtyCols' are the same of the columns
+
+	   'changed' is set by the round under way
+	   once it takes a live cell out
+	 */
+	int		rowClaim;
+	int		colClaim;
+	uint64_t*	goneCols;
+	uint64_t*	goneRows;
+	uint64_t*	dirtyRows;
+	uint64_t*	dirtyCols;
+	char		changed;
+
+	/*
+	   The dialog, see say_t: the built-in one
+	   unless 'dialog' is set, and the claim
+	   that the round under way checks against
+	 */
+	say_t		says[ MAX_SAYS ];
+	int		nSays;
+	char		dialog;
+	int		claim;
+
+	/*
+	   Sweep mode: the matrix is built once for the
+	   largest of the sum's upper bounds, a smaller
+	   'bound' is solved on a part of it - the sums
+	   up to the bound and the products of the pairs
+	   of numbers that add up to no more than that
+
+	   'born' of a product is the smallest sum of
+	   such a pair, 'bornRows' lists the products
+	   (rows) by it: those born of the sum 'col'
+	   are bornRows[ bornStart[ col ] ] through
+	   bornRows[ bornStart[ col + 1 ] - 1 ]
+
+	   As the bound grows by one, only its new
+	   column and the rows born of it are visited
+	   to bring up to date 'rowDeg' - the number
+	   of cells of a row within the bound - and
+	   'colDeg' - the number of rows within the
+	   bound in a column; these are the counts
+	   that each bound's rounds start with
+	 */
+	char		sweep;
+	int		sweepFrom; /* is the smallest sum's upper bound */
+	int		bound; /* is the sum's upper bound at hand */
+	int*		born;
+	idx_t*		bornStart;
+	idx_t*		bornRows;
+	int*		rowDeg;
+	int*		colDeg;
+
+	int		verbose; /* is one of VERBOSE_* */
+	char		survivors; /* print the pairs instead */
+	out_t		out;
+
+	/*
+	   Snapshots: 'stage' is the number of rounds
+	   of elimination done so far, a snapshot of
+	   each stage is written if 'snapPrefix' is
+	   set. A run resumed from a snapshot keeps
+	   it mapped in 'snap' and works on the arrays
+	   of the matrix right there
 	 */
-	char*		matrix; /* dynamically allocated 2D array */
+	int		stage;
+	const char*	snapPrefix;
+	snap_t		snap;
+
+	/*
+	   Out of core: 'rowStart', 'rowCols' and
+	   'colRows' are carved out of 'store',
+	   mapped from the file 'storePath', see
+	   matrixBytes(), mkMatrix() and
+	   rmSumsOfProducts() as to how they
+	   are walked. The products are had with
+	   no duplicates, see mapProducts()
+	 */
+	const char*	storePath;
+	store_t		store;
+
+	char		benchOn; /* report 'bench' at exit */
+	char		statsOn; /* as a table */
+	bench_t		bench;
+
+	/*
+	   Holds the arrays above, but for those
+	   of a snapshot or of the store, see
+	   arenaBytes()
+	 */
+	arena_t		arena;
 } fr_t;
 
 
-static void		rmSumsWithUniqueProduct( fr_t* );
-static void		rmProductsWithMultipleSums( fr_t* );
-static void		rmSumsWithMultipleProducts( fr_t* );
-static int		nSums( fr_t*, int, char, int* );
-static int		nLiveProducts( fr_t*, int, int* );
+/*
+   The counters of a build with -DFR_STATS,
+   see bench.h
+ */
+#define STAT_PAIRS		0 /* products, duplicates included */
+#define STAT_DUP_PRODUCTS	1
+#define STAT_CELLS		2 /* set in the matrix */
+#define STAT_FACTORIZATIONS	3
+#define STAT_NSUMS_CELLS	4 /* visited by nSums() */
+#define STAT_NLIVE_CELLS	5 /* visited by nLiveProducts() */
+#define STAT_RM_CELLS		6 /* visited by rmCol(), rmRow() */
+#define STAT_LIVE_SUMS		7 /* survivors of each round */
+#define STAT_LIVE_PRODUCTS	8
+#define STAT_VISITED		9 /* rows and columns a round checks */
+#define N_STATS			10
+
+
+/*
+   The sections of a snapshot, see snap.h: the
+   scalars first, then the arrays of the matrix,
+   the sparse or the dense ones, then the dialog
+   unless it is the built-in one
+ */
+#define SNAP_VERSION		3
+
+#define SNAP_PARAMS		1
+#define SNAP_COLS		2
+#define SNAP_ROWS		3
+#define SNAP_ROW_START		4
+#define SNAP_ROW_COLS		5
+#define SNAP_COL_START		6
+#define SNAP_COL_ROWS		7
+#define SNAP_BITS		8
+#define SNAP_TBITS		9
+#define SNAP_LIVE_COLS		10
+#define SNAP_LIVE_ROWS		11
+#define SNAP_DIALOG		12 /* 4 bytes per statement, see saveStage() */
+
+typedef struct
+{
+	int64_t		minInt;
+	int64_t		maxInt;
+	int64_t		minSum;
+	int64_t		maxSum;
+	int64_t		nCols;
+	int64_t		nRows;
+	int64_t		nCells;
+	int64_t		dense;
+	int64_t		stage;
+	int64_t		numSize; /* is sizeof( num_t ) */
+} snapParams_t;
+
+
+static void		nextSay( fr_t*, int );
+static void		runSay( fr_t*, int );
+static int		loopsBack( fr_t*, int );
+static void		repeatSays( fr_t*, int, int );
+static int		fits( int, int );
+static uint64_t		toVisit( fr_t*, uint64_t*, idx_t, idx_t, int );
+static void		orWord( fr_t*, uint64_t*, idx_t, uint64_t );
+static void		markRows( fr_t* );
+static void		markRowsIn( void*, int64_t, int64_t, int );
+static void		markCols( fr_t* );
+static void		markColsIn( void*, int64_t, int64_t, int );
+static void		rmSumsOfProducts( fr_t* );
+static void		rmSumsOfProductsIn( void*, int64_t, int64_t, int );
+static void		rmDoomedCols( void*, int64_t, int64_t, int );
+static void		rmProductsOfSums( fr_t* );
+static void		rmProductsOfSumsIn( void*, int64_t, int64_t, int );
+static void		rmDoomedRows( void*, int64_t, int64_t, int );
+static void		markSumsOf( fr_t*, idx_t, uint64_t* );
+static void		markProductsOf( fr_t*, int, uint64_t* );
+static void		rmProducts( fr_t* );
+static void		rmProductsIn( void*, int64_t, int64_t, int );
+static void		rmSums( fr_t* );
+static void		rmSumsIn( void*, int64_t, int64_t, int );
+static int		nSums( fr_t*, idx_t, char, int* );
+static int		nLiveProducts( fr_t*, int, idx_t* );
+static void		rmCol( fr_t*, int );
+static void		rmRow( fr_t*, idx_t );
+static int		nDenseSums( fr_t*, idx_t, char, int* );
+static int		nDenseProducts( fr_t*, int, idx_t* );
+static int		popcountAnd( const uint64_t*, const uint64_t*, idx_t );
 
 static fr_t*		init( int, char* [], fr_t* );
+static int		mkDialog( fr_t*, const char* );
+static int		parseDialog( fr_t*, const char**, int );
+static int		compileDialog( fr_t* );
+static int		sayErr( fr_t*, int, const char* );
 static void		mkSums( fr_t* );
-static int		mkProducts( fr_t* );
-static void		rmDupProducts( fr_t* );
-static void		mkMatrix( fr_t* );
+static idx_t		nCellRoom( fr_t* );
+static size_t		arenaBytes( fr_t*, idx_t );
+static size_t		matrixBytes( fr_t*, idx_t, size_t ( * )( size_t ) );
+static void*		matrixAlloc( fr_t*, size_t );
+static size_t		maskBytes( idx_t, idx_t );
+static fr_t*		mkMasks( fr_t*, idx_t );
+static idx_t		mapProducts( fr_t*, idx_t );
+static void		mapProductsIn( void*, int64_t, int64_t, int );
+static idx_t		mkProducts( fr_t*, idx_t );
+static void		mkProductsIn( void*, int64_t, int64_t, int );
+static idx_t		rmDupProducts( fr_t*, idx_t );
+static idx_t		mkMatrix( fr_t* );
+static idx_t		mkBits( fr_t* );
+static int		nFactorSums( fr_t*, prod_t, int* );
+static idx_t		prodRow( fr_t*, prod_t );
+static void		printRound( fr_t* );
+static void		printCounts( fr_t* );
+static void		countLive( fr_t*, int*, idx_t* );
 static void		printFr( fr_t* );
 static int		cmpNums( const void*, const void* );
 static void		printAnswers( fr_t* );
-static void		getXY( fr_t*, int, int, int*, int* );
+static void		printSurvivors( fr_t*, const char* );
+static void		getXY( fr_t*, prod_t, int, int*, int* );
+
+static idx_t		rowEnd( fr_t*, idx_t );
+static int		mkSweep( fr_t* );
+static void		sweep( fr_t* );
+static void		growBound( fr_t* );
+static void		startBound( fr_t* );
+
+static int		saveStage( fr_t* );
+static fr_t*		loadStage( fr_t*, const char* );
+static void*		stageArray( fr_t*, uint32_t, uint64_t );
 
 
 extern int
@@ -114,7 +539,22 @@ main( int argc, char* argv[] )
 	fr_t*		rv;
 	fr_t		fr = { 0 };
 	int		ec = 0;
+	int		fd;
+	out_t		err;
+#ifdef FR_STATS
+	static const char*	statNames[ N_STATS ] =
+	{
+		"pairs", "dupProducts", "cells", "factorizations",
+		"nSumsCells", "nLiveProductsCells", "rmCells",
+		"liveSums", "liveProducts", "visited"
+	};
+#endif
+
 
+	mkBench( &fr.bench, "cfreudenthal" );
+#ifdef FR_STATS
+	benchCounters( &fr.bench, statNames, N_STATS );
+#endif
 
 	rv = init( argc, argv, &fr );
 	if ( !rv )
@@ -123,41 +563,114 @@ main( int argc, char* argv[] )
 		goto out;
 	}
 
-	printf( "Initial matrix:\n" );
-	printFr( &fr );
+	if ( fr.sweep )
+	{
+		sweep( &fr );
+		benchPhase( &fr.bench, "sweep" );
+		goto out;
+	}
+
+	/*
+	   Stage k is the matrix once statement k of
+	   the dialog is made; a resumed run picks up
+	   at the stage of its snapshot
+	 */
+	if ( !fr.snap.base && !fr.says[ 0 ].fused )
+	{
+		nextSay( &fr, 0 );
+	}
 
-	rmSumsWithUniqueProduct( &fr );
+	for ( ; fr.stage < fr.nSays; fr.stage++ )
+	{
+		if ( fr.survivors )
+		{
+			printSurvivors( &fr, fr.says[ fr.stage ].name );
+		}
+		else
+		{
+			printRound( &fr );
+		}
 
-	printf( "\nSurvivors of \"S1: I knew that\":\n" );
-	printFr( &fr );
+		if ( fr.snapPrefix && saveStage( &fr ) < 0 )
+		{
+			ec = 1;
+		}
+		benchPhase( &fr.bench, "output" );
 
-	rmProductsWithMultipleSums( &fr );
+		if ( fr.stage + 1 < fr.nSays && !fr.says[ fr.stage + 1 ].fused )
+		{
+			nextSay( &fr, fr.stage + 1 );
+		}
+	}
 
-	printf( "\nSurvivors of \"P2: But then I know\":\n" );
-	printFr( &fr );
+	if ( !fr.survivors )
+	{
+		outStr( &fr.out, fr.verbose > VERBOSE_ANSWERS ?
+			"\nAnswer(s):\n" : "Answer(s):\n" );
+		printAnswers( &fr );
+	}
 
-	rmSumsWithMultipleProducts( &fr );
+out:
+	fd = fr.out.fd;
+	if ( rmOut( &fr.out ) < 0 )
+	{
+		ec = 1;
+	}
+	benchPhase( &fr.bench, "output" );
 
-	printf( "\nSurvivors of \"S2: And so do I\":\n" );
-	printFr( &fr );
+	/*
+	   A resumed run does not know its pairs,
+	   it has but the cells - the pairs and
+	   the squares among the factors
+	 */
+	if ( rv && ( fr.benchOn || fr.statsOn ) && mkOut( &err, STDERR_FILENO ) )
+	{
+		fr.bench.minInt = fr.minInt;
+		fr.bench.maxSum = fr.maxSum;
+		fr.bench.nThreads = fr.nThreads;
+		if ( fr.bench.nPairs == 0 )
+		{
+			fr.bench.nPairs = fr.nCells;
+		}
+		if ( fr.benchOn )
+		{
+			benchReport( &fr.bench, &err );
+		}
+		if ( fr.statsOn )
+		{
+			benchSummary( &fr.bench, &err );
+		}
+		rmOut( &err );
+	}
 
-	printf( "\nAnswer(s):\n" );
-	printAnswers( &fr );
+	if ( fd > STDERR_FILENO )
+	{
+		close( fd );
+	}
 
-out:
-	if ( fr.cols )
+	/*
+	   The state goes all at once, the matrix
+	   of a resumed run is in the snapshot
+	 */
+	if ( fr.snap.base )
 	{
-		free( fr.cols );
+		unmapSnap( &fr.snap );
 	}
 
-	if ( fr.rows )
+	if ( fr.store.base )
 	{
-		free( fr.rows );
+		rmStore( &fr.store );
 	}
 
-	if ( fr.matrix )
+	rmArena( &fr.arena );
+
+	rmNumMap( &fr.prodMap );
+
+	rmSieve( &fr.sieve );
+
+	if ( fr.pool.nThreads )
 	{
-		free( fr.matrix );
+		rmPool( &fr.pool );
 	}
 
 	return ec;
@@ -165,473 +678,3101 @@ out:
 
 
 /*
-   For each product (row):
-
-   if a current product (row) has only one
-   sum associated with it - eliminate the
-   column corresponding to that sum in its
-   entirty
+   Make the statement 'k' of the dialog in
+   the run, charging it with its round: one
+   that closes a fixed point has it go round
+   once more if it is to, see say_t
  */
 static void
-rmSumsWithUniqueProduct( fr_t* fr )
+nextSay( fr_t* fr, int k )
 {
-	int		row;
+	int		first;
+#ifdef FR_STATS
 	int		nsums;
-	int		thisColumn;
-	char		all = 0;
+	idx_t		nproducts;
+#endif
 
 
-	for ( row = 0; row < fr->nRows; row++ )
+	runSay( fr, k );
+#ifdef FR_STATS
+	countLive( fr, &nsums, &nproducts );
+	BENCH_COUNT( STAT_LIVE_SUMS, nsums );
+	BENCH_COUNT( STAT_LIVE_PRODUCTS, nproducts );
+#endif
+	benchPhase( &fr->bench, fr->says[ k ].name );
+
+	first = loopsBack( fr, k );
+	if ( first >= 0 )
 	{
-		nsums = nSums( fr, row, all, &thisColumn );
+		repeatSays( fr, first, k );
+	}
+}
 
-		if ( nsums != 1 )
+
+/*
+   Make the statement 'k' of the dialog: run
+   its round of elimination, if it has one,
+   see say_t, and note whether it took any
+   live cell out
+ */
+static void
+runSay( fr_t* fr, int k )
+{
+	say_t*		say = &fr->says[ k ];
+
+
+	fr->changed = 0;
+
+	if ( say->fused )
+	{
+		say->changed = 0;
+		return;
+	}
+
+	if ( say->claim == CLAIM_KNEW )
+	{
+		fr->claim = fr->says[ k - 1 ].claim;
+		if ( say->speaker == 'S' )
 		{
-			continue;
+			rmSumsOfProducts( fr );
+		}
+		else
+		{
+			rmProductsOfSums( fr );
+		}
+	}
+	else
+	{
+		fr->claim = say->claim;
+		if ( say->speaker == 'S' )
+		{
+			rmSums( fr );
+		}
+		else
+		{
+			rmProducts( fr );
 		}
+	}
+
+	say->changed = fr->changed;
+}
+
+
+/*
+   Whether the statement 'k' closes a fixed
+   point, see say_t, that is to go round once
+   more - for any of its statements took a
+   live cell out
+
+   Returns the first statement of it if so,
+   -1 otherwise
+ */
+static int
+loopsBack( fr_t* fr, int k )
+{
+	int		first;
+	int		changed = 0;
+
+
+	if ( !( fr->says[ k ].loop & LOOP_LAST ) )
+	{
+		return -1;
+	}
 
-		fr->cols[ thisColumn ].live = 0;
+	for ( first = k; ; first-- )
+	{
+		changed |= fr->says[ first ].changed;
+		if ( fr->says[ first ].loop & LOOP_FIRST )
+		{
+			break;
+		}
 	}
+
+	return changed ? first : -1;
 }
 
 
 /*
-   For each product (row):
+   Go round the fixed point of the statements
+   'first' through 'last' once more: a copy of
+   them goes right after them and closes the
+   fixed point in their stead, the statements
+   are renamed
+
+   The fixed point ends where it is once the
+   dialog has no room for another copy
+ */
+static void
+repeatSays( fr_t* fr, int first, int last )
+{
+	int		n = last - first + 1;
+
+
+	if ( fr->nSays + n > MAX_SAYS )
+	{
+		outErr( "cfreudenthal", "the fixed point is cut short, the dialog "
+			"has no room for more statements", fr->says[ last ].name );
+		return;
+	}
+
+	memmove( &fr->says[ last + 1 + n ], &fr->says[ last + 1 ],
+		( fr->nSays - last - 1 ) * sizeof( say_t ) );
+	memcpy( &fr->says[ last + 1 ], &fr->says[ first ], n * sizeof( say_t ) );
+	fr->says[ first ].loop &= ~LOOP_FIRST;
+	fr->says[ last ].loop &= ~LOOP_LAST;
+	fr->nSays += n;
+
+	compileDialog( fr );
+}
+
+
+/*
+   Whether a product with 'n' live sums, or
+   a sum with 'n' live products, is one its
+   owner could say 'claim' of
+ */
+static int
+fits( int claim, int n )
+{
+	return claim == CLAIM_NO ? n > 1 : n == 1;
+}
+
+
+/*
+   The rows (or the columns) of the 64 in the
+   word 'w' of 'dirty' that a round is to visit:
+   only those marked there if it checks against
+   'known' - the claim they were last checked
+   against, see fr->rowClaim - all 'n' of them
+   otherwise. The marks are taken off either way
+
+   The rows of a word are visited by a single
+   thread, which is the one to take them off
+ */
+static uint64_t
+toVisit( fr_t* fr, uint64_t* dirty, idx_t w, idx_t n, int known )
+{
+	uint64_t	word = dirty[ w ];
+
+
+	dirty[ w ] = 0;
+	if ( known != fr->claim )
+	{
+		word = w < ( n - 1 ) / 64 || n % 64 == 0 ? ~( uint64_t )0 :
+			( ( uint64_t )1 << ( n % 64 ) ) - 1;
+	}
+	BENCH_COUNT( STAT_VISITED, __builtin_popcountll( word ) );
+
+	return word;
+}
+
+
+/*
+   Set the 'bits' of the word 'w' of 'mask':
+   any number of threads may set the same
+   ones at once
+ */
+static void
+orWord( fr_t* fr, uint64_t* mask, idx_t w, uint64_t bits )
+{
+	if ( fr->pool.nThreads > 1 )
+	{
+		__atomic_fetch_or( &mask[ w ], bits, __ATOMIC_RELAXED );
+	}
+	else
+	{
+		mask[ w ] |= bits;
+	}
+}
 
-   keep the current product (row) iff it has
-   exactly one live sum associated with it,
-   eliminate that row (product) in its entirty
-   otherwise
+
+/*
+   Ready the rows for a round that checks
+   them against fr->claim, see fr->rowClaim:
+   if they were last checked against it, the
+   live rows of the columns eliminated since
+   are marked to be visited. Those columns
+   are done with either way
+ */
+static void
+markRows( fr_t* fr )
+{
+	if ( fr->rowClaim == fr->claim )
+	{
+		runPool( &fr->pool, markRowsIn, fr, fr->nColWords );
+	}
+
+	memset( fr->goneCols, 0, fr->nColWords * sizeof( uint64_t ) );
+}
+
+
+/*
+   markRows() of the columns of the
+   words 'lo' through 'hi' - 1
+ */
+static void
+markRowsIn( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	fr_t*		fr = ( fr_t* )arg;
+	int		w;
+	uint64_t	word;
+
+
+	( void )thread;
+
+	for ( w = lo; w < hi; w++ )
+	{
+		for ( word = fr->goneCols[ w ]; word; word &= word - 1 )
+		{
+			markProductsOf( fr, w * 64 + __builtin_ctzll( word ),
+				fr->dirtyRows );
+		}
+	}
+}
+
+
+/*
+   markRows() the other way round: the live
+   columns of the rows eliminated since
+ */
+static void
+markCols( fr_t* fr )
+{
+	if ( fr->colClaim == fr->claim )
+	{
+		runPool( &fr->pool, markColsIn, fr, fr->nRowWords );
+	}
+
+	memset( fr->goneRows, 0, fr->nRowWords * sizeof( uint64_t ) );
+}
+
+
+/*
+   markCols() of the rows of the
+   words 'lo' through 'hi' - 1
+ */
+static void
+markColsIn( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	fr_t*		fr = ( fr_t* )arg;
+	idx_t		w;
+	uint64_t	word;
+
+
+	( void )thread;
+
+	for ( w = lo; w < hi; w++ )
+	{
+		for ( word = fr->goneRows[ w ]; word; word &= word - 1 )
+		{
+			markSumsOf( fr, w * 64 + __builtin_ctzll( word ),
+				fr->dirtyCols );
+		}
+	}
+}
+
+
+/*
+   "I knew that" said by S: for each live
+   product (row):
+
+   if the current product (row) does not fit
+   P's claim - eliminate the columns of all
+   of its live sums in their entirety
+
+   The rows only mark such columns, which are
+   then eliminated in their order: the rows
+   and the columns are each walked in turn,
+   from the first to the last. Whether a row
+   fits does not depend on what has been
+   eliminated, nor does the outcome on the
+   order
+
+   Past it every live row fits the claim but
+   for those with no live sum left, as the
+   rows that do not fit it are, see
+   fr->rowClaim
+ */
+static void
+rmSumsOfProducts( fr_t* fr )
+{
+	markRows( fr );
+	memset( fr->doomed, 0, fr->nColWords * sizeof( uint64_t ) );
+
+	runPool( &fr->pool, rmSumsOfProductsIn, fr, fr->nRowWords );
+	fr->rowClaim = fr->claim;
+
+	runPool( &fr->pool, rmDoomedCols, fr, fr->nColWords );
+}
+
+
+/*
+   rmSumsOfProducts() of the rows of
+   the words 'lo' through 'hi' - 1
  */
 static void
-rmProductsWithMultipleSums( fr_t* fr )
+rmSumsOfProductsIn( void* arg, int64_t lo, int64_t hi, int thread )
 {
-	int		row;
+	fr_t*		fr = ( fr_t* )arg;
+	idx_t		w;
+	idx_t		row;
 	int		nsums;
+	int		thisColumn;
+	int		changed = 0;
 	char		liveOnly = 1;
+	uint64_t	word;
 
 
-	for ( row = 0; row < fr->nRows; row++ )
-	{
-		nsums = nSums( fr, row, liveOnly, NULL );
+	( void )thread;
 
-		if ( nsums == 1 )
+	for ( w = lo; w < hi; w++ )
+	{
+		word = toVisit( fr, fr->dirtyRows, w, fr->nRows, fr->rowClaim );
+		for ( ; word; word &= word - 1 )
+		{
+			row = w * 64 + __builtin_ctzll( word );
+			if ( !fr->rows[ row ].live )
+			{
+				continue;
+			}
+
+			nsums = nSums( fr, row, liveOnly, &thisColumn );
+
+			if ( fits( fr->claim, nsums ) || nsums == 0 )
+			{
+				continue;
+			}
+			changed = 1;
+
+			if ( nsums == 1 )
+			{
+				orWord( fr, fr->doomed, thisColumn >> 6,
+					( uint64_t )1 << ( thisColumn & 63 ) );
+			}
+			else
+			{
+				markSumsOf( fr, row, fr->doomed );
+			}
+		}
+	}
+
+	if ( changed )
+	{
+		__atomic_store_n( &fr->changed, 1, __ATOMIC_RELAXED );
+	}
+}
+
+
+/*
+   Eliminate the marked ones of the
+   columns of the words 'lo' through
+   'hi' - 1
+ */
+static void
+rmDoomedCols( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	fr_t*		fr = ( fr_t* )arg;
+	int		w;
+	uint64_t	word;
+
+
+	( void )thread;
+
+	for ( w = lo; w < hi; w++ )
+	{
+		for ( word = fr->doomed[ w ]; word; word &= word - 1 )
+		{
+			rmCol( fr, w * 64 + __builtin_ctzll( word ) );
+		}
+	}
+}
+
+
+/*
+   "I knew that" said by P: rmSumsOfProducts()
+   the other way round, the columns mark the
+   rows of the live products of each live sum
+   that does not fit S's claim
+ */
+static void
+rmProductsOfSums( fr_t* fr )
+{
+	markCols( fr );
+	memset( fr->doomed, 0, fr->nRowWords * sizeof( uint64_t ) );
+
+	runPool( &fr->pool, rmProductsOfSumsIn, fr, fr->nColWords );
+	fr->colClaim = fr->claim;
+
+	runPool( &fr->pool, rmDoomedRows, fr, fr->nRowWords );
+}
+
+
+/*
+   rmProductsOfSums() of the columns
+   of the words 'lo' through 'hi' - 1
+ */
+static void
+rmProductsOfSumsIn( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	fr_t*		fr = ( fr_t* )arg;
+	int		w;
+	int		col;
+	int		nproducts;
+	idx_t		thisRow;
+	int		changed = 0;
+	uint64_t	word;
+
+
+	( void )thread;
+
+	for ( w = lo; w < hi; w++ )
+	{
+		word = toVisit( fr, fr->dirtyCols, w, fr->nCols, fr->colClaim );
+		for ( ; word; word &= word - 1 )
+		{
+			col = w * 64 + __builtin_ctzll( word );
+			if ( !fr->cols[ col ].live )
+			{
+				continue;
+			}
+
+			nproducts = nLiveProducts( fr, col, &thisRow );
+
+			if ( fits( fr->claim, nproducts ) || nproducts == 0 )
+			{
+				continue;
+			}
+			changed = 1;
+
+			if ( nproducts == 1 )
+			{
+				orWord( fr, fr->doomed, thisRow >> 6,
+					( uint64_t )1 << ( thisRow & 63 ) );
+			}
+			else
+			{
+				markProductsOf( fr, col, fr->doomed );
+			}
+		}
+	}
+
+	if ( changed )
+	{
+		__atomic_store_n( &fr->changed, 1, __ATOMIC_RELAXED );
+	}
+}
+
+
+/*
+   Eliminate the marked ones of the
+   rows of the words 'lo' through
+   'hi' - 1
+ */
+static void
+rmDoomedRows( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	fr_t*		fr = ( fr_t* )arg;
+	idx_t		w;
+	uint64_t	word;
+
+
+	( void )thread;
+
+	for ( w = lo; w < hi; w++ )
+	{
+		for ( word = fr->doomed[ w ]; word; word &= word - 1 )
+		{
+			rmRow( fr, w * 64 + __builtin_ctzll( word ) );
+		}
+	}
+}
+
+
+/*
+   Mark the columns of all the live
+   sums of the given row in 'mask'
+ */
+static void
+markSumsOf( fr_t* fr, idx_t row, uint64_t* mask )
+{
+	idx_t		i;
+	int		w;
+	int		col;
+	uint64_t	word;
+
+
+	if ( fr->dense )
+	{
+		for ( w = 0; w < fr->nColWords; w++ )
+		{
+			word = fr->bits[ ( size_t )row * fr->nColWords + w ] &
+				fr->liveCols[ w ];
+			if ( word )
+			{
+				orWord( fr, mask, w, word );
+			}
+		}
+
+		return;
+	}
+
+	for ( i = fr->rowStart[ row ]; i < rowEnd( fr, row ); i++ )
+	{
+		col = fr->rowCols[ i ];
+		if ( fr->cols[ col ].live )
+		{
+			orWord( fr, mask, col >> 6, ( uint64_t )1 << ( col & 63 ) );
+		}
+	}
+}
+
+
+/*
+   Mark the rows of all the live products
+   of the given column in 'mask'
+ */
+static void
+markProductsOf( fr_t* fr, int col, uint64_t* mask )
+{
+	idx_t		i;
+	idx_t		w;
+	idx_t		row;
+	uint64_t	word;
+
+
+	if ( fr->dense )
+	{
+		for ( w = 0; w < fr->nRowWords; w++ )
+		{
+			word = fr->tbits[ ( size_t )col * fr->nRowWords + w ] &
+				fr->liveRows[ w ];
+			if ( word )
+			{
+				orWord( fr, mask, w, word );
+			}
+		}
+
+		return;
+	}
+
+	for ( i = fr->colStart[ col ]; i < fr->colStart[ col + 1 ]; i++ )
+	{
+		row = fr->colRows[ i ];
+		if ( fr->rows[ row ].live )
+		{
+			orWord( fr, mask, row >> 6, ( uint64_t )1 << ( row & 63 ) );
+		}
+	}
+}
+
+
+/*
+   "I do not know" or "I know" said by P: for
+   each live product (row):
+
+   keep the current product (row) iff the
+   number of its live sums fits the claim,
+   eliminate that row (product) in its
+   entirety otherwise
+
+   Only the rows that lost a live sum since
+   the last such round are visited if that
+   one checked against the same claim: the
+   rest still fit it
+ */
+static void
+rmProducts( fr_t* fr )
+{
+	markRows( fr );
+	runPool( &fr->pool, rmProductsIn, fr, fr->nRowWords );
+	fr->rowClaim = fr->claim;
+}
+
+
+/*
+   rmProducts() of the rows of the
+   words 'lo' through 'hi' - 1
+ */
+static void
+rmProductsIn( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	fr_t*		fr = ( fr_t* )arg;
+	idx_t		w;
+	idx_t		row;
+	int		nsums;
+	int		changed = 0;
+	char		liveOnly = 1;
+	uint64_t	word;
+
+
+	( void )thread;
+
+	for ( w = lo; w < hi; w++ )
+	{
+		word = toVisit( fr, fr->dirtyRows, w, fr->nRows, fr->rowClaim );
+		for ( ; word; word &= word - 1 )
+		{
+			row = w * 64 + __builtin_ctzll( word );
+			if ( !fr->rows[ row ].live )
+			{
+				continue;
+			}
+
+			nsums = nSums( fr, row, liveOnly, NULL );
+
+			if ( fits( fr->claim, nsums ) )
+			{
+				continue;
+			}
+
+			rmRow( fr, row );
+			changed |= nsums > 0;
+		}
+	}
+
+	if ( changed )
+	{
+		__atomic_store_n( &fr->changed, 1, __ATOMIC_RELAXED );
+	}
+}
+
+
+/*
+   "I do not know" or "I know" said by S: for
+   each live sum (column):
+
+   keep the current live sum (column) iff the
+   number of its live products fits the claim,
+   eliminate that column (sum) in its entirety
+   otherwise, see rmProducts()
+ */
+static void
+rmSums( fr_t* fr )
+{
+	markCols( fr );
+	runPool( &fr->pool, rmSumsIn, fr, fr->nColWords );
+	fr->colClaim = fr->claim;
+}
+
+
+/*
+   rmSums() of the columns of the
+   words 'lo' through 'hi' - 1
+ */
+static void
+rmSumsIn( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	fr_t*		fr = ( fr_t* )arg;
+	int		w;
+	int		col;
+	int		nproducts;
+	int		changed = 0;
+	uint64_t	word;
+
+
+	( void )thread;
+
+	for ( w = lo; w < hi; w++ )
+	{
+		word = toVisit( fr, fr->dirtyCols, w, fr->nCols, fr->colClaim );
+		for ( ; word; word &= word - 1 )
+		{
+			col = w * 64 + __builtin_ctzll( word );
+			if ( !fr->cols[ col ].live )
+			{
+				continue;
+			}
+
+			nproducts = nLiveProducts( fr, col, NULL );
+
+			if ( fits( fr->claim, nproducts ) )
+			{
+				continue;
+			}
+
+			rmCol( fr, col );
+			changed |= nproducts > 0;
+		}
+	}
+
+	if ( changed )
+	{
+		__atomic_store_n( &fr->changed, 1, __ATOMIC_RELAXED );
+	}
+}
+
+
+/*
+   Compute the number of sums,
+   optionally live only, in the
+   given row
+
+   The count is at hand, the row's
+   cells are only walked for the
+   last such sum's column
+ */
+static int
+nSums( fr_t* fr, idx_t row, char liveOnly, int* thisColumn )
+{
+	idx_t		i;
+	int		col;
+	int		nsums;
+
+
+	if ( fr->dense )
+	{
+		return nDenseSums( fr, row, liveOnly, thisColumn );
+	}
+
+	if ( liveOnly )
+	{
+		nsums = fr->rows[ row ].nLive;
+	}
+	else
+	{
+		nsums = rowEnd( fr, row ) - fr->rowStart[ row ];
+	}
+
+	if ( !thisColumn || nsums == 0 )
+	{
+		return nsums;
+	}
+
+	for ( i = rowEnd( fr, row ) - 1; i >= fr->rowStart[ row ]; i-- )
+	{
+		col = fr->rowCols[ i ];
+		if ( liveOnly && !fr->cols[ col ].live )
+		{
+			continue;
+		}
+
+		*thisColumn = col;
+		break;
+	}
+	BENCH_COUNT( STAT_NSUMS_CELLS, rowEnd( fr, row ) - i );
+
+	return nsums;
+}
+
+
+/*
+   Compute the number of live
+   products in the given column
+
+   The count is at hand, the column's
+   cells are only walked for the last
+   such product's row
+ */
+static int
+nLiveProducts( fr_t* fr, int col, idx_t* thisRow )
+{
+	idx_t		i;
+	idx_t		row;
+	int		nproducts;
+
+
+	if ( fr->dense )
+	{
+		return nDenseProducts( fr, col, thisRow );
+	}
+
+	nproducts = fr->cols[ col ].nLive;
+	if ( !thisRow || nproducts == 0 )
+	{
+		return nproducts;
+	}
+
+	for ( i = fr->colStart[ col + 1 ] - 1; i >= fr->colStart[ col ]; i-- )
+	{
+		row = fr->colRows[ i ];
+		if ( !fr->rows[ row ].live )
+		{
+			continue;
+		}
+
+		*thisRow = row;
+		break;
+	}
+	BENCH_COUNT( STAT_NLIVE_CELLS, fr->colStart[ col + 1 ] - i );
+
+	return nproducts;
+}
+
+
+/*
+   Eliminate the sum (column), mark it in
+   fr->goneCols and take it off the live
+   count of every product (row) that has it
+
+   With more than one thread at it, two
+   rows can eliminate the same column at
+   once (the first round) and two columns
+   can take off the same row's count at
+   once: only the one to clear the flag
+   goes on, the counts are taken atomically
+ */
+static void
+rmCol( fr_t* fr, int col )
+{
+	idx_t		i;
+	int		shared = fr->pool.nThreads > 1;
+	uint64_t	bit = ( uint64_t )1 << ( col & 63 );
+
+
+	if ( shared )
+	{
+		if ( !__atomic_exchange_n( &fr->cols[ col ].live, 0,
+			__ATOMIC_RELAXED ) )
+		{
+			return;
+		}
+	}
+	else
+	{
+		if ( !fr->cols[ col ].live )
+		{
+			return;
+		}
+
+		fr->cols[ col ].live = 0;
+	}
+	orWord( fr, fr->goneCols, col >> 6, bit );
+
+	if ( fr->dense )
+	{
+		if ( shared )
+		{
+			__atomic_fetch_and( &fr->liveCols[ col >> 6 ], ~bit,
+				__ATOMIC_RELAXED );
+		}
+		else
+		{
+			fr->liveCols[ col >> 6 ] &= ~bit;
+		}
+
+		return;
+	}
+
+	BENCH_COUNT( STAT_RM_CELLS, fr->colStart[ col + 1 ] - fr->colStart[ col ] );
+	for ( i = fr->colStart[ col ]; i < fr->colStart[ col + 1 ]; i++ )
+	{
+		if ( shared )
+		{
+			__atomic_fetch_sub( &fr->rows[ fr->colRows[ i ] ].nLive, 1,
+				__ATOMIC_RELAXED );
+		}
+		else
+		{
+			fr->rows[ fr->colRows[ i ] ].nLive--;
+		}
+	}
+}
+
+
+/*
+   Eliminate the product (row), mark it in
+   fr->goneRows and take it off the live
+   count of every sum (column) that it has,
+   see rmCol()
+ */
+static void
+rmRow( fr_t* fr, idx_t row )
+{
+	idx_t		i;
+	int		shared = fr->pool.nThreads > 1;
+	uint64_t	bit = ( uint64_t )1 << ( row & 63 );
+
+
+	if ( shared )
+	{
+		if ( !__atomic_exchange_n( &fr->rows[ row ].live, 0,
+			__ATOMIC_RELAXED ) )
+		{
+			return;
+		}
+	}
+	else
+	{
+		if ( !fr->rows[ row ].live )
+		{
+			return;
+		}
+
+		fr->rows[ row ].live = 0;
+	}
+	orWord( fr, fr->goneRows, row >> 6, bit );
+
+	if ( fr->dense )
+	{
+		if ( shared )
+		{
+			__atomic_fetch_and( &fr->liveRows[ row >> 6 ], ~bit,
+				__ATOMIC_RELAXED );
+		}
+		else
+		{
+			fr->liveRows[ row >> 6 ] &= ~bit;
+		}
+
+		return;
+	}
+
+	BENCH_COUNT( STAT_RM_CELLS, rowEnd( fr, row ) - fr->rowStart[ row ] );
+	for ( i = fr->rowStart[ row ]; i < rowEnd( fr, row ); i++ )
+	{
+		if ( shared )
+		{
+			__atomic_fetch_sub( &fr->cols[ fr->rowCols[ i ] ].nLive, 1,
+				__ATOMIC_RELAXED );
+		}
+		else
+		{
+			fr->cols[ fr->rowCols[ i ] ].nLive--;
+		}
+	}
+}
+
+
+/*
+   nSums() of the dense matrix: the row's
+   bits, ANDed with the live columns if
+   only those count, are counted
+ */
+static int
+nDenseSums( fr_t* fr, idx_t row, char liveOnly, int* thisColumn )
+{
+	int		w;
+	int		nsums;
+	uint64_t	word;
+	uint64_t*	bits = fr->bits + ( size_t )row * fr->nColWords;
+
+
+	/*
+	   ANDed with itself a row is
+	   counted as it is
+	 */
+	nsums = popcountAnd( bits, liveOnly ? fr->liveCols : bits,
+		fr->nColWords );
+	BENCH_COUNT( STAT_NSUMS_CELLS, ( long long )fr->nColWords * 64 );
+	if ( !thisColumn || nsums == 0 )
+	{
+		return nsums;
+	}
+
+	for ( w = fr->nColWords - 1; w >= 0; w-- )
+	{
+		word = bits[ w ];
+		if ( liveOnly )
+		{
+			word &= fr->liveCols[ w ];
+		}
+
+		if ( word )
+		{
+			*thisColumn = w * 64 + 63 - __builtin_clzll( word );
+			break;
+		}
+	}
+
+	return nsums;
+}
+
+
+/*
+   nLiveProducts() of the dense matrix:
+   the column's bits, ANDed with the live
+   rows, are counted
+ */
+static int
+nDenseProducts( fr_t* fr, int col, idx_t* thisRow )
+{
+	idx_t		w;
+	int		nproducts;
+	uint64_t	word;
+	uint64_t*	tbits = fr->tbits + ( size_t )col * fr->nRowWords;
+
+
+	nproducts = popcountAnd( tbits, fr->liveRows, fr->nRowWords );
+	BENCH_COUNT( STAT_NLIVE_CELLS, ( long long )fr->nRowWords * 64 );
+	if ( !thisRow || nproducts == 0 )
+	{
+		return nproducts;
+	}
+
+	for ( w = fr->nRowWords - 1; w >= 0; w-- )
+	{
+		word = tbits[ w ] & fr->liveRows[ w ];
+		if ( word )
+		{
+			*thisRow = w * 64 + 63 - __builtin_clzll( word );
+			break;
+		}
+	}
+
+	return nproducts;
+}
+
+
+/*
+   The number of bits set in both 'a'
+   and 'b', 'n' 64-bit words long
+
+   AVX-512 has a popcount of its own,
+   AVX2 looks up the counts of nibbles
+   and adds them up per 64-bit lane; the
+   words left over, or all of them with
+   neither at hand, are counted one by one
+ */
+static int
+popcountAnd( const uint64_t* a, const uint64_t* b, idx_t n )
+{
+	idx_t		i = 0;
+	long long	cnt = 0;
+
+
+#if defined( __AVX512F__ ) && defined( __AVX512VPOPCNTDQ__ )
+	__m512i		v;
+	__m512i		acc = _mm512_setzero_si512();
+
+
+	for ( ; i + 8 <= n; i += 8 )
+	{
+		v = _mm512_and_si512( _mm512_loadu_si512( a + i ),
+			_mm512_loadu_si512( b + i ) );
+		acc = _mm512_add_epi64( acc, _mm512_popcnt_epi64( v ) );
+	}
+
+	cnt += _mm512_reduce_add_epi64( acc );
+#elif defined( __AVX2__ )
+	__m256i		v;
+	__m256i		lo;
+	__m256i		hi;
+	__m256i		acc = _mm256_setzero_si256();
+	__m256i		nibble = _mm256_set1_epi8( 0x0f );
+	__m256i		lut = _mm256_setr_epi8(
+				0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+				0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+	long long	lanes[ 4 ];
+
+
+	for ( ; i + 4 <= n; i += 4 )
+	{
+		v = _mm256_and_si256(
+			_mm256_loadu_si256( ( const __m256i* )( a + i ) ),
+			_mm256_loadu_si256( ( const __m256i* )( b + i ) ) );
+		lo = _mm256_and_si256( v, nibble );
+		hi = _mm256_and_si256( _mm256_srli_epi16( v, 4 ), nibble );
+		v = _mm256_add_epi8( _mm256_shuffle_epi8( lut, lo ),
+			_mm256_shuffle_epi8( lut, hi ) );
+		acc = _mm256_add_epi64( acc,
+			_mm256_sad_epu8( v, _mm256_setzero_si256() ) );
+	}
+
+	_mm256_storeu_si256( ( __m256i* )lanes, acc );
+	cnt += lanes[ 0 ] + lanes[ 1 ] + lanes[ 2 ] + lanes[ 3 ];
+#endif
+
+	for ( ; i < n; i++ )
+	{
+		cnt += __builtin_popcountll( a[ i ] & b[ i ] );
+	}
+
+	return ( int )cnt;
+}
+
+
+static void
+printAnswers( fr_t* fr )
+{
+	int		x;
+	int		y;
+	idx_t		row;
+	int		col;
+	prod_t		product;
+	int		sum;
+	int		nsums;
+	char		liveOnly = 1;
+
+
+	for ( row = 0; row < fr->nRows; row++ )
+	{
+		if ( !fr->rows[ row ].live )
+		{
+			continue;
+		}
+
+		nsums = nSums( fr, row, liveOnly, &col );
+
+		if ( nsums != 1 )
+		{
+			continue;
+		}
+
+		product = fr->rows[ row ].num;
+		sum = ( int )fr->cols[ col ].num;
+		getXY( fr, product, sum, &x, &y );
+
+		outStr( &fr->out, "product = " );
+		outInt( &fr->out, product );
+		outStr( &fr->out, ", sum = " );
+		outInt( &fr->out, sum );
+		outStr( &fr->out, ", x = " );
+		outInt( &fr->out, x );
+		outStr( &fr->out, ", y = " );
+		outInt( &fr->out, y );
+		outChar( &fr->out, '\n' );
+	}
+}
+
+
+/*
+   Print the pairs of numbers of the live cells,
+   each one as "'name' x y", a column after
+   another: those that survive the stage 'name'
+
+   A fused statement has no round of its own,
+   see say_t: it is survived by the live cells
+   whose product, or sum, fits its claim - P1
+   by the pairs whose product has more than
+   one sum
+
+   A cell of a square, a pair of equal numbers,
+   is none of the problem's and is not printed
+ */
+static void
+printSurvivors( fr_t* fr, const char* name )
+{
+	int		x;
+	int		y;
+	idx_t		i;
+	idx_t		w;
+	idx_t		row;
+	int		col;
+	uint64_t	word;
+	char		liveOnly = 1;
+	say_t*		say = &fr->says[ fr->stage ];
+
+
+	for ( col = 0; col < fr->nCols; col++ )
+	{
+		if ( !fr->cols[ col ].live || ( say->fused && say->speaker == 'S' &&
+			!fits( say->claim, nLiveProducts( fr, col, NULL ) ) ) )
+		{
+			continue;
+		}
+
+		i = fr->dense ? 0 : fr->colStart[ col ];
+		w = -1;
+		word = 0;
+		for ( ;; )
+		{
+			/*
+			   The next row of the column
+			 */
+			if ( fr->dense )
+			{
+				while ( !word && ++w < fr->nRowWords )
+				{
+					word = fr->tbits[ ( size_t )col * fr->nRowWords + w ];
+				}
+				if ( !word )
+				{
+					break;
+				}
+				row = w * 64 + __builtin_ctzll( word );
+				word &= word - 1;
+			}
+			else
+			{
+				if ( i == fr->colStart[ col + 1 ] )
+				{
+					break;
+				}
+				row = fr->colRows[ i++ ];
+			}
+
+			if ( !fr->rows[ row ].live || ( say->fused &&
+				say->speaker == 'P' &&
+				!fits( say->claim, nSums( fr, row, liveOnly, NULL ) ) ) )
+			{
+				continue;
+			}
+
+			getXY( fr, fr->rows[ row ].num, ( int )fr->cols[ col ].num, &x, &y );
+			if ( x == y )
+			{
+				continue;
+			}
+
+			outStr( &fr->out, name );
+			outChar( &fr->out, ' ' );
+			outInt( &fr->out, x );
+			outChar( &fr->out, ' ' );
+			outInt( &fr->out, y );
+			outChar( &fr->out, '\n' );
+		}
+	}
+}
+
+
+/*
+   'x' and 'y' are the roots of
+
+      t^2 - 'sum' * t + 'product' = 0
+
+   that is ( 'sum' -/+ d ) / 2, where d is the
+   square root of 'sum'^2 - 4 * 'product'; they
+   are 0 unless the roots are whole numbers no
+   less than 'minInt'
+
+ */
+static void
+getXY( fr_t* fr, prod_t product, int sum, int* x, int* y )
+{
+	prod_t		disc = ( prod_t )sum * sum - 4 * product;
+	prod_t		d;
+
+
+	*x = *y = 0;
+
+	if ( disc < 0 )
+	{
+		return;
+	}
+
+	d = isqrt64( disc );
+	if ( d * d != disc || ( sum - d ) % 2 || ( sum - d ) / 2 < fr->minInt )
+	{
+		return;
+	}
+
+	*x = ( int )( ( sum - d ) / 2 );
+	*y = ( int )( ( sum + d ) / 2 );
+}
+
+
+static fr_t*
+init( int argc, char* argv[], fr_t* fr )
+{
+	idx_t		npairs;
+	idx_t		nrows;
+	prod_t		maxProd;
+	int		opt;
+	const char*	resume = NULL;
+	const char*	dialog = NULL;
+	struct option	longOpts[] =
+	{
+		{ "sweep", no_argument, NULL, 'w' },
+		{ "bench", no_argument, NULL, 'b' },
+		{ "stats", no_argument, NULL, 'S' },
+		{ "survivors", no_argument, NULL, 'p' },
+		{ "dialog", required_argument, NULL, 'D' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+
+	fr->nThreads = 1;
+	fr->verbose = VERBOSE_FULL;
+	fr->out.fd = STDOUT_FILENO;
+	fr->rowClaim = -1;
+	fr->colClaim = -1;
+
+	while ( ( opt = getopt_long( argc, argv, "dj:m:o:r:s:v:", longOpts, NULL ) ) != -1 )
+	{
+		switch ( opt )
+		{
+		case 'd':
+			fr->dense = 1;
+			break;
+
+		case 'o':
+			fr->out.fd = open( optarg, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+			if ( fr->out.fd < 0 )
+			{
+				return NULL;
+			}
+			break;
+
+		case 'v':
+			fr->verbose = atoi( optarg );
+			if ( fr->verbose < VERBOSE_ANSWERS || fr->verbose > VERBOSE_FULL )
+			{
+				return NULL;
+			}
+			break;
+
+		case 'm':
+			fr->storePath = optarg;
+			break;
+
+		case 'r':
+			resume = optarg;
+			break;
+
+		case 's':
+			fr->snapPrefix = optarg;
+			break;
+
+		case 'w':
+			fr->sweep = 1;
+			break;
+
+		case 'b':
+			fr->benchOn = 1;
+			break;
+
+		case 'S':
+			fr->statsOn = 1;
+			break;
+
+		case 'p':
+			fr->survivors = 1;
+			break;
+
+		case 'D':
+			dialog = optarg;
+			break;
+
+		case 'j':
+			fr->nThreads = atoi( optarg );
+			if ( fr->nThreads < 1 )
+			{
+				return NULL;
+			}
+			break;
+
+		default:
+			return NULL;
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	if ( !mkOut( &fr->out, fr->out.fd ) )
+	{
+		return NULL;
+	}
+
+	/*
+	   The sweep has no stages
+	   to snapshot
+	 */
+	if ( fr->sweep && ( resume || fr->snapPrefix || fr->survivors ) )
+	{
+		return NULL;
+	}
+
+	/*
+	   Only the sparse matrix being built
+	   goes out of core
+	 */
+	if ( fr->storePath && ( fr->dense || resume ) )
+	{
+		return NULL;
+	}
+
+	/*
+	   A resumed run goes on with the bounds
+	   and the dialog of its snapshot
+	 */
+	if ( resume && dialog )
+	{
+		outErr( "cfreudenthal", "the dialog is that of the snapshot, "
+			"not to be given", dialog );
+		return NULL;
+	}
+
+	if ( resume && argc > 0 )
+	{
+		outErr( "cfreudenthal", "the bounds are those of the snapshot, "
+			"not to be given", argv[ 0 ] );
+		return NULL;
+	}
+
+	if ( !resume && mkDialog( fr, dialog ) < 0 )
+	{
+		return NULL;
+	}
+
+	if ( resume )
+	{
+		if ( !mkPool( &fr->pool, fr->nThreads ) )
+		{
+			return NULL;
+		}
+
+		if ( !loadStage( fr, resume ) ||
+			!mkArena( &fr->arena, maskBytes( fr->nCols, fr->nRows ) ) )
+		{
+			return NULL;
+		}
+
+		mkMasks( fr, fr->nRows );
+		benchPhase( &fr->bench, "load" );
+
+		return fr;
+	}
+
+	if ( argc < 2 + fr->sweep )
+	{
+		return NULL;
+	}
+
+	fr->minInt = atoi( argv[ 0 ] );
+	if ( fr->minInt <= 0 )
+	{
+		outErr( "cfreudenthal", "the numbers' lower bound is less than 1",
+			argv[ 0 ] );
+		return NULL;
+	}
+
+	fr->minSum = fr->minInt + fr->minInt;
+	fr->maxSum = atoi( argv[ 1 + fr->sweep ] );
+	if ( fr->maxSum <= fr->minSum )
+	{
+		outErr( "cfreudenthal", "no pairs of numbers add up to as little "
+			"as the sum's upper bound", argv[ 1 + fr->sweep ] );
+		return NULL;
+	}
+
+	/*
+	   The products are 64-bit, but only
+	   up to MAX_PRODUCT
+	 */
+	maxProd = ( prod_t )( fr->maxSum / 2 ) * ( fr->maxSum - fr->maxSum / 2 );
+	if ( maxProd >= MAX_PRODUCT )
+	{
+		outErr( "cfreudenthal", "the sum's upper bound takes the products "
+			"past 2^48", argv[ 1 + fr->sweep ] );
+		return NULL;
+	}
+
+	/*
+	   The sweep is set up for its largest
+	   bound, on the sparse matrix only
+	 */
+	if ( fr->sweep )
+	{
+		fr->sweepFrom = atoi( argv[ 1 ] );
+		if ( fr->sweepFrom <= fr->minSum || fr->sweepFrom > fr->maxSum ||
+			fr->dense )
+		{
+			return NULL;
+		}
+	}
+
+	fr->maxInt = fr->maxSum - fr->minInt;
+
+	if ( !mkPool( &fr->pool, fr->nThreads ) )
+	{
+		return NULL;
+	}
+
+	/*
+	   The products are had by the rows' map
+	   first, see mapProducts(), which tells
+	   how many rows there are to be: they are
+	   indexed by an idx_t. All of the state
+	   is had in one go, at its largest
+	 */
+	npairs = nPairs( fr->minInt, fr->maxSum );
+	nrows = mapProducts( fr, npairs );
+
+	fr->nCols = fr->maxSum - fr->minSum + 1;
+	fr->cellRoom = fr->dense ? 0 : nCellRoom( fr );
+	if ( !mkArena( &fr->arena, arenaBytes( fr, nrows ) ) )
+	{
+		outErr( "cfreudenthal", "no room for the matrix of the sum's upper "
+			"bound", argv[ 1 + fr->sweep ] );
+		return NULL;
+	}
+
+	if ( fr->storePath && !mkStore( &fr->store, fr->storePath,
+		matrixBytes( fr, nrows, storeSize ) ) )
+	{
+		outErr( "cfreudenthal", "no room for the store", fr->storePath );
+		return NULL;
+	}
+
+	fr->cols = ( num_t* )arenaAlloc( &fr->arena, fr->nCols * sizeof( num_t ) );
+	fr->rows = ( num_t* )arenaAlloc( &fr->arena, nrows * sizeof( num_t ) );
+	if ( !fr->cols || !fr->rows || !mkMasks( fr, nrows ) )
+	{
+		return NULL;
+	}
+
+	mkSums( fr );
+
+	/*
+	   Populate the actual products
+	 */
+	fr->nRows = mkProducts( fr, npairs );
+	fr->bench.nPairs = npairs;
+	BENCH_COUNT( STAT_PAIRS, npairs );
+	BENCH_COUNT( STAT_DUP_PRODUCTS, npairs - fr->nRows );
+	fr->nColWords = ( fr->nCols + 63 ) / 64;
+	fr->nRowWords = ( fr->nRows + 63 ) / 64;
+	benchPhase( &fr->bench, "products" );
+
+
+	/*
+	   The products are factored by the smallest
+	   prime factor table, the sieve goes as high
+	   as the largest one (the last, once sorted)
+	   if it fits in an int and there is room for
+	   that, and as high as the largest sum
+	   otherwise - the products past it are
+	   factored by trial division
+	 */
+	maxProd = fr->nRows > 0 ? fr->rows[ fr->nRows - 1 ].num : 0;
+	if ( ( maxProd > INT_MAX || !mkSieve( &fr->sieve, ( int )maxProd, 1 ) ) &&
+		!mkSieve( &fr->sieve, fr->maxSum, 1 ) )
+	{
+		return NULL;
+	}
+	benchPhase( &fr->bench, "sieve" );
+
+	if ( fr->dense )
+	{
+		rmNumMap( &fr->prodMap );
+
+		fr->nCells = mkBits( fr );
+		if ( fr->nCells < 0 )
+		{
+			return NULL;
+		}
+		BENCH_COUNT( STAT_CELLS, fr->nCells );
+		benchPhase( &fr->bench, "matrix" );
+
+		return fr;
+	}
+
+
+	/*
+	   Lay out and populate the adjacency: there
+	   is a cell per pair of factors of a product
+	   that adds up to a legal sum, see nCellRoom()
+	 */
+	fr->rowStart = ( idx_t* )matrixAlloc( fr, ( fr->nRows + 1 ) * sizeof( idx_t ) );
+	fr->colStart = ( idx_t* )arenaAlloc( &fr->arena, ( fr->nCols + 1 ) * sizeof( idx_t ) );
+	fr->rowCols = ( int* )matrixAlloc( fr, fr->cellRoom * sizeof( int ) );
+	fr->colRows = ( idx_t* )matrixAlloc( fr, fr->cellRoom * sizeof( idx_t ) );
+	if ( !fr->rowStart || !fr->colStart || !fr->rowCols || !fr->colRows )
+	{
+		return NULL;
+	}
+
+	fr->nCells = mkMatrix( fr );
+	if ( fr->nCells < 0 )
+	{
+		outErr( "cfreudenthal", "no room for the cells of the sum's upper "
+			"bound", argv[ 1 + fr->sweep ] );
+		return NULL;
+	}
+	rmNumMap( &fr->prodMap );
+	BENCH_COUNT( STAT_CELLS, fr->nCells );
+	benchPhase( &fr->bench, "matrix" );
+
+	if ( fr->sweep && mkSweep( fr ) < 0 )
+	{
+		return NULL;
+	}
+
+	return fr;
+}
+
+
+/*
+   The most cells the matrix can have: for
+   each sum, the pairs of factors a <= sum - a
+   whose product is no less than the smallest
+   legal one, minInt * ( minInt + 1 ). The
+   factors are 2 or more, whatever 'minInt' is,
+   and a * ( sum - a ) grows with 'a', so that
+   they are those from the smallest such 'a'
+   up to sum / 2
+ */
+static idx_t
+nCellRoom( fr_t* fr )
+{
+	prod_t		minProd = ( prod_t )fr->minInt * ( fr->minInt + 1 );
+	prod_t		disc;
+	prod_t		a;
+	idx_t		n = 0;
+	int		sum;
+
+
+	for ( sum = fr->minSum; sum <= fr->maxSum; sum++ )
+	{
+		disc = ( prod_t )sum * sum - 4 * minProd;
+		if ( disc < 0 )
+		{
+			continue;
+		}
+
+		a = ( sum - isqrt64( disc ) ) / 2;
+		while ( a > 2 && ( a - 1 ) * ( sum - a + 1 ) >= minProd )
+		{
+			a--;
+		}
+
+		while ( a < 2 || a * ( sum - a ) < minProd )
+		{
+			a++;
+		}
+
+		if ( a <= sum / 2 )
+		{
+			n += sum / 2 - a + 1;
+		}
+	}
+
+	return n;
+}
+
+
+/*
+   The size of the arena: each piece of the
+   state as large as it can get for 'nrows'
+   rows, but for the arrays of matrixBytes()
+   if they are had from the store
+ */
+static size_t
+arenaBytes( fr_t* fr, idx_t nrows )
+{
+	size_t		colWords = ( fr->nCols + 63 ) / 64;
+	size_t		rowWords = ( nrows + 63 ) / 64;
+	size_t		n;
+
+
+	n = arenaSize( fr->nCols * sizeof( num_t ) ) +
+		arenaSize( nrows * sizeof( num_t ) ) +
+		maskBytes( fr->nCols, nrows );
+
+	if ( fr->dense )
+	{
+		return n + arenaSize( nrows * colWords * sizeof( uint64_t ) ) +
+			arenaSize( fr->nCols * rowWords * sizeof( uint64_t ) ) +
+			arenaSize( colWords * sizeof( uint64_t ) ) +
+			arenaSize( rowWords * sizeof( uint64_t ) );
+	}
+
+	n += arenaSize( ( fr->nCols + 1 ) * sizeof( idx_t ) );
+
+	if ( !fr->storePath )
+	{
+		n += matrixBytes( fr, nrows, arenaSize );
+	}
+
+	if ( fr->sweep )
+	{
+		n += 2 * arenaSize( nrows * sizeof( int ) ) +
+			arenaSize( nrows * sizeof( idx_t ) ) +
+			arenaSize( ( fr->nCols + 1 ) * sizeof( idx_t ) ) +
+			arenaSize( fr->nCols * sizeof( int ) );
+	}
+
+	return n;
+}
+
+
+/*
+   The size of the adjacency of the sparse
+   matrix for 'nrows' rows, each array rounded
+   up by 'size': the offsets of the rows and
+   the cells, as many as fr->cellRoom. It goes
+   to the store, if there is one, to be walked
+   in its order - the rest of the state is
+   looked up all over and stays in the arena
+ */
+static size_t
+matrixBytes( fr_t* fr, idx_t nrows, size_t ( *size )( size_t ) )
+{
+	return size( ( nrows + 1 ) * sizeof( idx_t ) ) +
+		size( fr->cellRoom * sizeof( int ) ) +
+		size( fr->cellRoom * sizeof( idx_t ) );
+}
+
+
+/*
+   An array of matrixBytes(): 'size' bytes,
+   all zeros, of the store if there is one,
+   of the arena otherwise
+
+   Returns NULL if there is no room for it
+ */
+static void*
+matrixAlloc( fr_t* fr, size_t size )
+{
+	if ( fr->store.base )
+	{
+		return storeAlloc( &fr->store, size );
+	}
+
+	return arenaAlloc( &fr->arena, size );
+}
+
+
+/*
+   The size of the bitmasks of the
+   rounds, see fr->doomed and fr->rowClaim,
+   for 'ncols' columns and 'nrows' rows
+ */
+static size_t
+maskBytes( idx_t ncols, idx_t nrows )
+{
+	size_t		colWords = ( ncols + 63 ) / 64;
+	size_t		rowWords = ( nrows + 63 ) / 64;
+
+
+	return arenaSize( ( colWords > rowWords ? colWords : rowWords ) *
+		sizeof( uint64_t ) ) +
+		2 * arenaSize( colWords * sizeof( uint64_t ) ) +
+		2 * arenaSize( rowWords * sizeof( uint64_t ) );
+}
+
+
+/*
+   Carve the bitmasks out of the arena,
+   room for 'nrows' rows
+
+   Returns NULL if there is no room
+   for them, 'fr' otherwise
+ */
+static fr_t*
+mkMasks( fr_t* fr, idx_t nrows )
+{
+	size_t		colWords = ( fr->nCols + 63 ) / 64;
+	size_t		rowWords = ( nrows + 63 ) / 64;
+
+
+	fr->doomed = ( uint64_t* )arenaAlloc( &fr->arena,
+		( colWords > rowWords ? colWords : rowWords ) * sizeof( uint64_t ) );
+	fr->goneCols = ( uint64_t* )arenaAlloc( &fr->arena,
+		colWords * sizeof( uint64_t ) );
+	fr->goneRows = ( uint64_t* )arenaAlloc( &fr->arena,
+		rowWords * sizeof( uint64_t ) );
+	fr->dirtyCols = ( uint64_t* )arenaAlloc( &fr->arena,
+		colWords * sizeof( uint64_t ) );
+	fr->dirtyRows = ( uint64_t* )arenaAlloc( &fr->arena,
+		rowWords * sizeof( uint64_t ) );
+
+	return fr->doomed && fr->goneCols && fr->goneRows &&
+		fr->dirtyCols && fr->dirtyRows ? fr : NULL;
+}
+
+
+/*
+   Compile the dialog 'text', see --dialog, or
+   the built-in one if it is NULL, into the
+   statements fr->says
+
+   Returns 0, -1 if 'text' is not a dialog
+ */
+static int
+mkDialog( fr_t* fr, const char* text )
+{
+	const char*	p = text ? text : "P:no S:knew P:yes S:yes";
+
+
+	fr->nSays = 0;
+	fr->dialog = text != NULL;
+
+	if ( parseDialog( fr, &p, 0 ) < 0 )
+	{
+		return -1;
+	}
+
+	return compileDialog( fr );
+}
+
+
+/*
+   Parse the statements of '*text' into
+   fr->says past those there, up to the
+   end or to a ')' that closes a group
+   'depth' parentheses deep
+
+   Returns 0, -1 if there is no parsing it
+ */
+static int
+parseDialog( fr_t* fr, const char** text, int depth )
+{
+	const char*	words[ 3 ] = { "no", "yes", "knew" };
+	const char*	p = *text;
+	const char*	group;
+	char*		end;
+	long		times;
+	int		first;
+	int		claim;
+	int		i;
+	size_t		len = 0;
+
+
+	for ( ;; )
+	{
+		while ( *p == ' ' || *p == '\t' || *p == ',' )
+		{
+			p++;
+		}
+
+		if ( *p == '\0' || *p == ')' )
+		{
+			break;
+		}
+
+		first = fr->nSays;
+		if ( *p == '(' )
+		{
+			if ( depth == 8 )
+			{
+				outErr( "cfreudenthal", "the groups go more than 8 deep",
+					p );
+				return -1;
+			}
+
+			group = p++;
+			if ( parseDialog( fr, &p, depth + 1 ) < 0 )
+			{
+				return -1;
+			}
+
+			if ( *p != ')' )
+			{
+				outErr( "cfreudenthal", "a group is not closed", group );
+				return -1;
+			}
+			p++;
+		}
+		else
+		{
+			if ( ( *p != 'P' && *p != 'S' ) || p[ 1 ] != ':' )
+			{
+				outErr( "cfreudenthal", "not a statement", p );
+				return -1;
+			}
+
+			if ( fr->nSays == MAX_SAYS )
+			{
+				outErr( "cfreudenthal", "the dialog has no room for "
+					"more statements", p );
+				return -1;
+			}
+
+			for ( claim = 0; claim < 3; claim++ )
+			{
+				len = strlen( words[ claim ] );
+				if ( !strncmp( p + 2, words[ claim ], len ) &&
+					( p[ 2 + len ] < 'a' || p[ 2 + len ] > 'z' ) )
+				{
+					break;
+				}
+			}
+			if ( claim == 3 )
+			{
+				outErr( "cfreudenthal", "not a statement", p );
+				return -1;
+			}
+
+			fr->says[ fr->nSays ].speaker = *p;
+			fr->says[ fr->nSays ].claim = ( char )claim;
+			fr->nSays++;
+			p += 2 + len;
+		}
+
+		/*
+		   The statements since 'first' are
+		   repeated as a whole, to a fixed
+		   point if no number is given - which
+		   holds no other one
+		 */
+		if ( *p == '*' && ( p[ 1 ] < '0' || p[ 1 ] > '9' ) )
+		{
+			for ( i = first; i < fr->nSays; i++ )
+			{
+				if ( fr->says[ i ].loop )
+				{
+					outErr( "cfreudenthal", "a fixed point within a "
+						"fixed point", p );
+					return -1;
+				}
+			}
+
+			fr->says[ first ].loop |= LOOP_FIRST;
+			fr->says[ fr->nSays - 1 ].loop |= LOOP_LAST;
+			p++;
+		}
+		else if ( *p == '*' )
+		{
+			times = strtol( p + 1, &end, 10 );
+			if ( end == p + 1 || times < 1 )
+			{
+				outErr( "cfreudenthal", "not a number of times", p );
+				return -1;
+			}
+
+			if ( ( times - 1 ) * ( fr->nSays - first ) > MAX_SAYS - fr->nSays )
+			{
+				outErr( "cfreudenthal", "the dialog has no room for "
+					"more statements", p );
+				return -1;
+			}
+			p = end;
+
+			for ( i = 0; i < ( times - 1 ) * ( fr->nSays - first ); i++ )
+			{
+				fr->says[ fr->nSays + i ] = fr->says[ first + i ];
+			}
+			fr->nSays += i;
+		}
+	}
+
+	if ( depth == 0 && *p != '\0' )
+	{
+		outErr( "cfreudenthal", "a ')' closes no group", p );
+		return -1;
+	}
+
+	*text = p;
+
+	return 0;
+}
+
+
+/*
+   Check the statements parsed, mark those
+   that are fused and name them
+
+   "I knew that" is said of the other's
+   statement right before, one of knowing
+   or not knowing. Neither does it open
+   a fixed point nor follow one: that
+   would be of two statements at once
+
+   Returns 0, -1 if the dialog makes no sense
+ */
+static int
+compileDialog( fr_t* fr )
+{
+	const char*	phrases[ 3 ] = { "I do not know", "I know", "I knew that" };
+	const char*	builtIn[ 4 ] =
+	{
+		"I can not name these numbers", "I knew that",
+		"But then I know", "And so do I"
+	};
+	int		counts[ 2 ] = { 0, 0 };
+	say_t*		say;
+	int		open = 0;
+	int		k;
+	int		n;
+	int		i;
+	char		digits[ 4 ];
+
+
+	if ( fr->nSays == 0 )
+	{
+		outErr( "cfreudenthal", "the dialog has no statements", NULL );
+		return -1;
+	}
+
+	for ( k = 0; k < fr->nSays; k++ )
+	{
+		say = &fr->says[ k ];
+		if ( ( say->speaker != 'P' && say->speaker != 'S' ) ||
+			say->claim < CLAIM_NO || say->claim > CLAIM_KNEW ||
+			say->loop & ~( LOOP_FIRST | LOOP_LAST ) )
+		{
+			return sayErr( fr, k, "not a statement" );
+		}
+
+		if ( say->claim == CLAIM_KNEW )
+		{
+			if ( k == 0 )
+			{
+				return sayErr( fr, k, "\"knew\" opens the dialog" );
+			}
+
+			if ( say[ -1 ].speaker == say->speaker )
+			{
+				return sayErr( fr, k, "\"knew\" is of the speaker's "
+					"own statement" );
+			}
+
+			if ( say[ -1 ].claim == CLAIM_KNEW )
+			{
+				return sayErr( fr, k, "\"knew\" is of another \"knew\"" );
+			}
+		}
+
+		if ( say->loop & LOOP_FIRST )
+		{
+			if ( open )
+			{
+				return sayErr( fr, k, "a fixed point within a fixed point" );
+			}
+
+			if ( say->claim == CLAIM_KNEW )
+			{
+				return sayErr( fr, k, "\"knew\" opens a fixed point" );
+			}
+			open = 1;
+		}
+
+		if ( say->loop & LOOP_LAST )
+		{
+			if ( !open )
+			{
+				return sayErr( fr, k, "a fixed point closes that is "
+					"not open" );
+			}
+
+			if ( k + 1 < fr->nSays && say[ 1 ].claim == CLAIM_KNEW )
+			{
+				return sayErr( fr, k + 1, "\"knew\" is of a fixed point" );
+			}
+			open = 0;
+		}
+
+		say->fused = k + 1 < fr->nSays && say[ 1 ].claim == CLAIM_KNEW;
+		say->phrase = fr->dialog ? phrases[ ( int )say->claim ] : builtIn[ k ];
+
+		/*
+		   The name is the speaker and the
+		   number of the speaker's statement
+		 */
+		n = ++counts[ say->speaker == 'S' ];
+		for ( i = 0; n > 0; n /= 10 )
+		{
+			digits[ i++ ] = '0' + n % 10;
+		}
+
+		say->name[ 0 ] = say->speaker;
+		for ( n = 1; i > 0; n++ )
+		{
+			say->name[ n ] = digits[ --i ];
+		}
+		say->name[ n ] = '\0';
+	}
+
+	return open ? sayErr( fr, fr->nSays - 1, "a fixed point is not closed" ) :
+		0;
+}
+
+
+/*
+   Tell why the statement 'k' of the dialog
+   makes no sense, naming it by its place
+   and as it would be written, "3 (S:knew)"
+
+   Returns -1
+ */
+static int
+sayErr( fr_t* fr, int k, const char* what )
+{
+	const char*	words[ 3 ] = { "no", "yes", "knew" };
+	say_t*		say = &fr->says[ k ];
+	char		text[ 24 ];
+	char		digits[ 8 ];
+	int		n;
+	int		i = 0;
+	int		j = 0;
+
+
+	for ( n = k + 1; n > 0; n /= 10 )
+	{
+		digits[ i++ ] = '0' + n % 10;
+	}
+	while ( i > 0 )
+	{
+		text[ j++ ] = digits[ --i ];
+	}
+
+	text[ j ] = '\0';
+	if ( ( say->speaker == 'P' || say->speaker == 'S' ) &&
+		say->claim >= CLAIM_NO && say->claim <= CLAIM_KNEW )
+	{
+		text[ j++ ] = ' ';
+		text[ j++ ] = '(';
+		text[ j++ ] = say->speaker;
+		text[ j++ ] = ':';
+		strcpy( text + j, words[ ( int )say->claim ] );
+		strcat( text, ")" );
+	}
+
+	outErr( "cfreudenthal", what, text );
+
+	return -1;
+}
+
+
+static void
+mkSums( fr_t* fr )
+{
+	int		sum;
+	int		col;
+
+
+	/*
+	   The array of sums is automatically
+	   sorted in the ascending order
+	 */
+	for ( sum = fr->minSum, col = 0; sum <= fr->maxSum; sum++, col++ )
+	{
+		fr->cols[ col ].num = sum;
+		fr->cols[ col ].live = 1;
+	}
+
+	mkDenseMap( &fr->sumMap, fr->minSum, fr->maxSum );
+}
+
+
+/*
+   Put the products of the 'npairs' pairs in
+   the sparse map of the rows, by value, a
+   range of the pairs per thread: the map is
+   sized by the range of the products, from
+   minInt * ( minInt + 1 ) up to that of the
+   pair closest to maxSum / 2, which is usually
+   many times smaller than an array of the
+   products with the duplicates would be. The
+   duplicates are never had then
+
+   Returns the number of the unique products,
+   'npairs' if the map is larger than that
+   array or can not be had
+ */
+static idx_t
+mapProducts( fr_t* fr, idx_t npairs )
+{
+	prod_t		hi = ( fr->maxSum - 1 ) / 2;
+	prod_t		minProd = ( prod_t )fr->minInt * ( fr->minInt + 1 );
+	prod_t		maxProd = hi * ( fr->maxSum - hi );
+
+
+	if ( npairs == 0 || sparseMapSize( minProd, maxProd ) >
+		npairs * ( prod_t )sizeof( num_t ) ||
+		!mkSparseMap( &fr->prodMap, minProd, maxProd ) )
+	{
+		return npairs;
+	}
+
+	runPool( &fr->pool, mapProductsIn, fr, npairs );
+
+	return numMapSeal( &fr->prodMap );
+}
+
+
+/*
+   mapProducts() of the pairs 'lo' through 'hi' - 1,
+   walked as by mkProductsIn()
+ */
+static void
+mapProductsIn( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	fr_t*		fr = ( fr_t* )arg;
+	int		a;
+	int		b;
+	idx_t		k;
+	prod_t		v;
+
+
+	( void )thread;
+
+	pairAt( fr->minInt, fr->maxSum, lo, &a, &b );
+	for ( k = lo; k < hi; k++ )
+	{
+		v = ( prod_t )a * b - fr->prodMap.min;
+		orWord( fr, fr->prodMap.bits, v >> 6, ( uint64_t )1 << ( v & 63 ) );
+
+		if ( ++b + a > fr->maxSum )
+		{
+			a++;
+			b = a + 1;
+		}
+	}
+}
+
+
+/*
+   Fill 'rows' with the unique products in the
+   ascending order: read back from the rows'
+   map in one pass if there is one, had from
+   the 'npairs' pairs and rid of the duplicates
+   otherwise, see rmDupProducts()
+
+   Returns the number of the products
+ */
+static idx_t
+mkProducts( fr_t* fr, idx_t npairs )
+{
+	nummap_t*	map = &fr->prodMap;
+	idx_t		n = 0;
+	prod_t		w;
+	uint64_t	word;
+
+
+	if ( !map->bits )
+	{
+		runPool( &fr->pool, mkProductsIn, fr, npairs );
+
+		return rmDupProducts( fr, npairs );
+	}
+
+	for ( w = 0; w < map->nWords; w++ )
+	{
+		for ( word = map->bits[ w ]; word; word &= word - 1 )
+		{
+			fr->rows[ n ].num = map->min + w * 64 + __builtin_ctzll( word );
+			fr->rows[ n ].live = 1;
+			n++;
+		}
+	}
+
+	return n;
+}
+
+
+/*
+   mkProducts() of the pairs 'lo' through 'hi' - 1,
+   with no map: the product of a pair is at the
+   pair's pairIndex(). The first one is had by
+   pairAt(), the rest by stepping to the next y,
+   or the next x once the sum goes past the bound
+ */
+static void
+mkProductsIn( void* arg, int64_t lo, int64_t hi, int thread )
+{
+	fr_t*		fr = ( fr_t* )arg;
+	int		a;
+	int		b;
+	idx_t		row;
+
+
+	( void )thread;
+
+	pairAt( fr->minInt, fr->maxSum, lo, &a, &b );
+	for ( row = lo; row < hi; row++ )
+	{
+		fr->rows[ row ].num = ( prod_t )a * b;
+		fr->rows[ row ].live = 1;
+
+		if ( ++b + a > fr->maxSum )
+		{
+			a++;
+			b = a + 1;
+		}
+	}
+}
+
+
+/*
+   Leave only the unique ones of the 'n'
+   products in 'rows', in the ascending order:
+   sort them and compact them in one pass, the
+   rows are then looked up by a binary search,
+   see prodRow()
+
+   Returns the number of them
+ */
+static idx_t
+rmDupProducts( fr_t* fr, idx_t n )
+{
+	idx_t		row;
+	idx_t		k = 0;
+
+
+	qsort( fr->rows, n, sizeof( num_t ), cmpNums );
+
+	for ( row = 0; row < n; row++ )
+	{
+		if ( k > 0 && fr->rows[ k - 1 ].num == fr->rows[ row ].num )
+		{
+			continue;
+		}
+
+		fr->rows[ k++ ] = fr->rows[ row ];
+	}
+
+	return k;
+}
+
+
+/*
+   For each product (row):
+
+   decompose the current product into all
+   possible pairs of factors, for each
+   pair of factors:
+
+      set the value in the matrix's cell
+      (in the current row) in the column
+      corresponding to the sum to which
+      these two factor add to to 1
+
+   The rows are laid out one after another as
+   they are populated, the row-major adjacency
+   in one pass: it has room for fr->cellRoom
+   cells. The column-major is laid out the same
+   way, a column after another, see below
+
+   Returns the total number of cells, -1 if
+   there are more than fr->cellRoom
+ */
+static idx_t
+mkMatrix( fr_t* fr )
+{
+	int		i;
+	int		n;
+	int		col;
+	idx_t		k;
+	idx_t		row;
+	idx_t		ncells = 0;
+	prod_t		a;
+	prod_t		sum;
+	int		sums[ MAX_DIVISORS64 / 2 ];
+
+
+	/*
+	   Row-major: the columns of each row
+	   come out in the ascending order
+	 */
+	for ( row = 0; row < fr->nRows; row++ )
+	{
+		n = nFactorSums( fr, fr->rows[ row ].num, sums );
+		if ( ncells + n > fr->cellRoom )
+		{
+			return -1;
+		}
+
+		fr->rowStart[ row ] = ncells;
+		fr->rows[ row ].nLive = n;
+		for ( i = 0; i < n; i++ )
+		{
+			fr->rowCols[ ncells + i ] = sums[ i ];
+		}
+		ncells += n;
+	}
+	fr->rowStart[ fr->nRows ] = ncells;
+
+
+	/*
+	   Column-major: the products of the sum are
+	   those of its pairs of factors a, sum - a
+	   for 2 <= a <= sum / 2 that are legal ones,
+	   had straight from the rows' map with no
+	   factoring. They grow with 'a', so the rows
+	   of each column come out in the ascending
+	   order, and the cells are written in their
+	   order, which suits the store out of core
+	 */
+	k = 0;
+	for ( col = 0; col < fr->nCols; col++ )
+	{
+		fr->colStart[ col ] = k;
+
+		sum = fr->cols[ col ].num;
+		for ( a = 2; a <= sum / 2; a++ )
+		{
+			row = prodRow( fr, a * ( sum - a ) );
+			if ( row >= 0 )
+			{
+				fr->colRows[ k++ ] = row;
+			}
+		}
+
+		fr->cols[ col ].nLive = k - fr->colStart[ col ];
+	}
+	fr->colStart[ fr->nCols ] = k;
+
+	return ncells;
+}
+
+
+/*
+   mkMatrix() of the dense matrix: the bits of
+   each row and of its transpose are set in
+   one go, all the rows and columns are live
+
+   Returns the total number of cells, -1 if
+   out of memory
+ */
+static idx_t
+mkBits( fr_t* fr )
+{
+	int		i;
+	int		n;
+	int		col;
+	idx_t		row;
+	idx_t		ncells = 0;
+	int		sums[ MAX_DIVISORS64 / 2 ];
+
+
+	fr->bits = ( uint64_t* )arenaAlloc( &fr->arena,
+		( size_t )fr->nRows * fr->nColWords * sizeof( uint64_t ) );
+	fr->tbits = ( uint64_t* )arenaAlloc( &fr->arena,
+		( size_t )fr->nCols * fr->nRowWords * sizeof( uint64_t ) );
+	fr->liveCols = ( uint64_t* )arenaAlloc( &fr->arena,
+		fr->nColWords * sizeof( uint64_t ) );
+	fr->liveRows = ( uint64_t* )arenaAlloc( &fr->arena,
+		fr->nRowWords * sizeof( uint64_t ) );
+	if ( !fr->bits || !fr->tbits || !fr->liveCols || !fr->liveRows )
+	{
+		return -1;
+	}
+
+	for ( row = 0; row < fr->nRows; row++ )
+	{
+		fr->liveRows[ row >> 6 ] |= ( uint64_t )1 << ( row & 63 );
+
+		n = nFactorSums( fr, fr->rows[ row ].num, sums );
+		for ( i = 0; i < n; i++ )
+		{
+			col = sums[ i ];
+			fr->bits[ ( size_t )row * fr->nColWords + ( col >> 6 ) ] |=
+				( uint64_t )1 << ( col & 63 );
+			fr->tbits[ ( size_t )col * fr->nRowWords + ( row >> 6 ) ] |=
+				( uint64_t )1 << ( row & 63 );
+		}
+		ncells += n;
+	}
+
+	for ( col = 0; col < fr->nCols; col++ )
+	{
+		fr->liveCols[ col >> 6 ] |= ( uint64_t )1 << ( col & 63 );
+	}
+
+	return ncells;
+}
+
+
+/*
+   Decompose the 'product' into all possible pairs
+   of factors and, for those whose sum is a legal
+   one, store the sum's column into 'cols' (if not
+   NULL) in the ascending order
+
+   Returns the number of such pairs of factors
+ */
+static int
+nFactorSums( fr_t* fr, prod_t product, int* cols )
+{
+	int		i;
+	prod_t		a[ MAX_DIVISORS64 / 2 ];
+	int		na;
+	prod_t		b;
+	int		n = 0;
+	prod_t		sum;
+	int		col;
+
+
+	na = factorPairs64( &fr->sieve, product, a );
+	BENCH_COUNT( STAT_FACTORIZATIONS, 1 );
+
+	/*
+	   The sum a + product / a decreases
+	   as 'a' grows up to the square root,
+	   walk down to emit ascending sums
+	 */
+	for ( i = na - 1; i >= 0; i-- )
+	{
+		b = product / a[ i ];
+		sum = a[ i ] + b;
+
+		col = numMapIndex( &fr->sumMap, sum );
+		if ( col < 0 )
 		{
 			continue;
 		}
 
-		fr->rows[ row ].live = 0;
+		if ( cols )
+		{
+			cols[ n ] = col;
+		}
+		n++;
+	}
+
+	return n;
+}
+
+
+/*
+   The row of the 'product', -1 if it is not
+   a legal one: by the rows' map or, if there
+   is none, by a binary search of the rows
+ */
+static idx_t
+prodRow( fr_t* fr, prod_t product )
+{
+	idx_t		lo = 0;
+	idx_t		hi = fr->nRows;
+	idx_t		mid;
+
+
+	if ( fr->prodMap.bits )
+	{
+		return numMapIndex( &fr->prodMap, product );
+	}
+
+	while ( lo < hi )
+	{
+		mid = lo + ( hi - lo ) / 2;
+		if ( fr->rows[ mid ].num < product )
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return lo < fr->nRows && fr->rows[ lo ].num == product ? lo : -1;
+}
+
+
+/*
+   The end of the row's cells: past the last
+   one, or the last one within the bound while
+   sweeping (the columns are ascending)
+ */
+static idx_t
+rowEnd( fr_t* fr, idx_t row )
+{
+	if ( fr->rowDeg )
+	{
+		return fr->rowStart[ row ] + fr->rowDeg[ row ];
 	}
+
+	return fr->rowStart[ row + 1 ];
 }
 
 
 /*
-   For each live sum (column):
+   Find out which sum each product is born
+   of and list the products by it, the bound
+   starts out below the smallest sum
 
-   keep the current live sum (column) iff it
-   has exactly one live product associated
-   with it, eliminate that column (sum) in
-   its entirty otherwise
+   Returns 0, -1 if out of memory
  */
-static void
-rmSumsWithMultipleProducts( fr_t* fr )
+static int
+mkSweep( fr_t* fr )
 {
+	int		i;
+	prod_t		a;
+	prod_t		b;
+	int		na;
+	idx_t		row;
 	int		col;
-	int		nproducts;
+	prod_t		as[ MAX_DIVISORS64 / 2 ];
 
 
-	for ( col = 0; col < fr->nCols; col++ )
+	fr->born = ( int* )arenaAlloc( &fr->arena, fr->nRows * sizeof( int ) );
+	fr->bornStart = ( idx_t* )arenaAlloc( &fr->arena, ( fr->nCols + 1 ) * sizeof( idx_t ) );
+	fr->bornRows = ( idx_t* )arenaAlloc( &fr->arena, fr->nRows * sizeof( idx_t ) );
+	fr->rowDeg = ( int* )arenaAlloc( &fr->arena, fr->nRows * sizeof( int ) );
+	fr->colDeg = ( int* )arenaAlloc( &fr->arena, fr->nCols * sizeof( int ) );
+	if ( !fr->born || !fr->bornStart || !fr->bornRows ||
+		!fr->rowDeg || !fr->colDeg )
 	{
-		if ( !fr->cols[ col ].live )
-		{
-			continue;
-		}
+		return -1;
+	}
 
-		nproducts = nLiveProducts( fr, col, NULL );
 
-		if ( nproducts == 1 )
+	/*
+	   The larger the smaller factor the
+	   smaller the sum, the first legal pair
+	   from the top has the smallest one
+	 */
+	for ( row = 0; row < fr->nRows; row++ )
+	{
+		na = factorPairs64( &fr->sieve, fr->rows[ row ].num, as );
+		for ( i = na - 1; i >= 0; i-- )
 		{
-			continue;
+			a = as[ i ];
+			b = fr->rows[ row ].num / a;
+			if ( a >= fr->minInt && a < b && a + b <= fr->maxSum )
+			{
+				fr->born[ row ] = ( int )( a + b );
+				break;
+			}
 		}
 
-		fr->cols[ col ].live = 0;
+		fr->bornStart[ numMapIndex( &fr->sumMap, fr->born[ row ] ) + 1 ]++;
+	}
+
+	for ( col = 0; col < fr->nCols; col++ )
+	{
+		fr->bornStart[ col + 1 ] += fr->bornStart[ col ];
+	}
+
+	for ( row = 0; row < fr->nRows; row++ )
+	{
+		col = numMapIndex( &fr->sumMap, fr->born[ row ] );
+		fr->bornRows[ fr->bornStart[ col ] + fr->colDeg[ col ]++ ] = row;
 	}
+
+	memset( fr->colDeg, 0, fr->nCols * sizeof( int ) );
+	fr->bound = fr->minSum - 1;
+
+	return 0;
 }
 
 
 /*
-   Compute the number of sums,
-   optionally live only, in the
-   given row
+   Solve for every sum's upper bound in the
+   range, printing the answer(s) of each one
  */
-static int
-nSums( fr_t* fr, int row, char liveOnly, int* thisColumn )
+static void
+sweep( fr_t* fr )
 {
-	char		v;
-	int		col;
-	int		nsums = 0;
+	int		k;
+	int		n;
+	int		first;
 
 
-	for ( col = 0; col < fr->nCols; col++ )
+	while ( fr->bound < fr->maxSum )
 	{
-		if ( liveOnly && !fr->cols[ col ].live )
+		growBound( fr );
+		if ( fr->bound < fr->sweepFrom )
 		{
 			continue;
 		}
 
-		v = *( fr->matrix + row * fr->nCols + col );
-		if ( v != 1 )
-		{
-			continue;
-		}
+		startBound( fr );
 
-		nsums++;
-		if ( thisColumn )
+		/*
+		   A fixed point goes round in place,
+		   'n' keeps count of the statements
+		   as repeatSays() would
+		 */
+		n = fr->nSays;
+		for ( k = 0; k < fr->nSays; k++ )
 		{
-			*thisColumn = col;
+			runSay( fr, k );
+
+			first = loopsBack( fr, k );
+			if ( first >= 0 && n + k - first + 1 <= MAX_SAYS )
+			{
+				n += k - first + 1;
+				k = first - 1;
+			}
 		}
-	}
 
-	return nsums;
+		outStr( &fr->out, "Answer(s) for minInt = " );
+		outInt( &fr->out, fr->minInt );
+		outStr( &fr->out, ", maxSum = " );
+		outInt( &fr->out, fr->bound );
+		outStr( &fr->out, ":\n" );
+		printAnswers( fr );
+	}
 }
 
 
 /*
-   Compute the number of live
-   products in the given column
+   Raise the bound by one: the cells of the
+   new sum (column) join their rows, and the
+   products (rows) born of the new sum join
+   the columns of all their cells
  */
-static int
-nLiveProducts( fr_t* fr, int col, int* thisRow )
+static void
+growBound( fr_t* fr )
 {
-	char		v;
-	int		row;
-	int		nproducts = 0;
+	idx_t		i;
+	idx_t		j;
+	idx_t		row;
+	int		col;
 
 
-	for ( row = 0; row < fr->nRows; row++ )
+	fr->bound++;
+	col = numMapIndex( &fr->sumMap, fr->bound );
+
+	for ( i = fr->colStart[ col ]; i < fr->colStart[ col + 1 ]; i++ )
 	{
-		if ( !fr->rows[ row ].live )
-		{
-			continue;
-		}
+		row = fr->colRows[ i ];
+		fr->rowDeg[ row ]++;
 
-		v = *( fr->matrix + row * fr->nCols + col );
-		if ( v != 1 )
+		if ( fr->born[ row ] <= fr->bound )
 		{
-			continue;
+			fr->colDeg[ col ]++;
 		}
+	}
 
-		nproducts++;
-		if ( thisRow )
+	for ( i = fr->bornStart[ col ]; i < fr->bornStart[ col + 1 ]; i++ )
+	{
+		row = fr->bornRows[ i ];
+		for ( j = fr->rowStart[ row ]; j < rowEnd( fr, row ); j++ )
 		{
-			*thisRow = row;
+			/*
+			   The new column has counted it already
+			 */
+			if ( fr->rowCols[ j ] != col )
+			{
+				fr->colDeg[ fr->rowCols[ j ] ]++;
+			}
 		}
 	}
-
-	return nproducts;
 }
 
 
+/*
+   Bring the rows and the columns back to
+   life as they are before the first round
+   for the bound at hand, none of them
+   checked yet
+ */
 static void
-printAnswers( fr_t* fr )
+startBound( fr_t* fr )
 {
-	int		x;
-	int		y;
-	int		row;
+	idx_t		row;
 	int		col;
-	int		product;
-	int		sum;
-	int		nsums;
-	char		liveOnly = 1;
+	int		ncols = fr->bound - fr->minSum + 1;
 
 
 	for ( row = 0; row < fr->nRows; row++ )
 	{
-		if ( !fr->rows[ row ].live )
-		{
-			continue;
-		}
-
-		nsums = nSums( fr, row, liveOnly, &col );
-
-		if ( nsums != 1 )
-		{
-			continue;
-		}
+		fr->rows[ row ].live = fr->born[ row ] <= fr->bound;
+		fr->rows[ row ].nLive = fr->rowDeg[ row ];
+	}
 
-		product = fr->rows[ row ].num;
-		sum = fr->cols[ col ].num;
-		getXY( fr, product, sum, &x, &y );
-		printf( "product = %d, sum = %d, x = %d, y = %d\n",
-			product, sum, x, y );
+	for ( col = 0; col < fr->nCols; col++ )
+	{
+		fr->cols[ col ].live = col < ncols;
+		fr->cols[ col ].nLive = fr->colDeg[ col ];
 	}
+
+	fr->rowClaim = -1;
+	fr->colClaim = -1;
 }
 
 
 /*
-   We can find 'x' and 'y' by:
-  
-   - decomposing the 'sum' into two terms and
-   finding those that multiply to 'product'
-
-   - decomposing the 'product' into two factors
-   and finding those that sum to 'sum'
-
-   we will use the sum method since that does
-   not require the square root calculation
+   Write the snapshot of the current stage
+   into 'snapPrefix'.<stage>
 
+   Returns 0, -1 if it can not be written
  */
-static void
-getXY( fr_t* fr, int product, int sum, int* x, int* y )
+static int
+saveStage( fr_t* fr )
 {
-	int		a;
-	int		b;
-	int		half = sum / 2;
+	snapParams_t	params;
+	snapSection_t	sections[ 8 ];
+	int		n = 0;
+	size_t		len = strlen( fr->snapPrefix );
+	char*		path;
+	char		dialog[ 4 * MAX_SAYS ];
+	int		stage;
+	int		i;
+	int		rv;
 
 
-	*x = *y = 0;
+	/*
+	   PREFIX.stage, the stage in decimal
+	 */
+	path = ( char* )malloc( len + 5 );
+	if ( !path )
+	{
+		return -1;
+	}
+	memcpy( path, fr->snapPrefix, len );
+	path[ len++ ] = '.';
+	for ( stage = fr->stage, i = 1; stage >= 10; stage /= 10 )
+	{
+		i++;
+	}
+	path[ len + i ] = '\0';
+	for ( stage = fr->stage; i > 0; stage /= 10 )
+	{
+		path[ len + --i ] = '0' + stage % 10;
+	}
+
+	memset( &params, 0, sizeof( params ) );
+	params.minInt = fr->minInt;
+	params.maxInt = fr->maxInt;
+	params.minSum = fr->minSum;
+	params.maxSum = fr->maxSum;
+	params.nCols = fr->nCols;
+	params.nRows = fr->nRows;
+	params.nCells = fr->nCells;
+	params.dense = fr->dense;
+	params.stage = fr->stage;
+	params.numSize = sizeof( num_t );
+
+	sections[ n++ ] = ( snapSection_t ){ SNAP_PARAMS, &params, sizeof( params ) };
+	sections[ n++ ] = ( snapSection_t ){ SNAP_COLS, fr->cols,
+		( uint64_t )fr->nCols * sizeof( num_t ) };
+	sections[ n++ ] = ( snapSection_t ){ SNAP_ROWS, fr->rows,
+		( uint64_t )fr->nRows * sizeof( num_t ) };
+
+	if ( fr->dense )
+	{
+		sections[ n++ ] = ( snapSection_t ){ SNAP_BITS, fr->bits,
+			( uint64_t )fr->nRows * fr->nColWords * sizeof( uint64_t ) };
+		sections[ n++ ] = ( snapSection_t ){ SNAP_TBITS, fr->tbits,
+			( uint64_t )fr->nCols * fr->nRowWords * sizeof( uint64_t ) };
+		sections[ n++ ] = ( snapSection_t ){ SNAP_LIVE_COLS, fr->liveCols,
+			( uint64_t )fr->nColWords * sizeof( uint64_t ) };
+		sections[ n++ ] = ( snapSection_t ){ SNAP_LIVE_ROWS, fr->liveRows,
+			( uint64_t )fr->nRowWords * sizeof( uint64_t ) };
+	}
+	else
+	{
+		sections[ n++ ] = ( snapSection_t ){ SNAP_ROW_START, fr->rowStart,
+			( uint64_t )( fr->nRows + 1 ) * sizeof( idx_t ) };
+		sections[ n++ ] = ( snapSection_t ){ SNAP_ROW_COLS, fr->rowCols,
+			( uint64_t )fr->nCells * sizeof( int ) };
+		sections[ n++ ] = ( snapSection_t ){ SNAP_COL_START, fr->colStart,
+			( uint64_t )( fr->nCols + 1 ) * sizeof( idx_t ) };
+		sections[ n++ ] = ( snapSection_t ){ SNAP_COL_ROWS, fr->colRows,
+			( uint64_t )fr->nCells * sizeof( idx_t ) };
+	}
 
-	for ( a = fr->minInt; a <= half; a++ )
+	/*
+	   The speaker, the claim, the fixed point
+	   marks and whether the round took a live
+	   cell out: a fixed point is gone round
+	   as far as the stage
+	 */
+	if ( fr->dialog )
 	{
-		b = sum - a;
-		if ( ( a * b ) == product )
+		for ( i = 0; i < fr->nSays; i++ )
 		{
-			*x = a;
-			*y = b;
-			return;
+			dialog[ 4 * i ] = fr->says[ i ].speaker;
+			dialog[ 4 * i + 1 ] = fr->says[ i ].claim;
+			dialog[ 4 * i + 2 ] = fr->says[ i ].loop;
+			dialog[ 4 * i + 3 ] = fr->says[ i ].changed;
 		}
+		sections[ n++ ] = ( snapSection_t ){ SNAP_DIALOG, dialog,
+			( uint64_t )fr->nSays * 4 };
 	}
+
+	rv = writeSnap( path, SNAP_VERSION, sections, n );
+
+	free( path );
+
+	return rv;
 }
 
 
+/*
+   Map the snapshot 'path' and take the
+   bounds, the stage and the matrix from it
+
+   Returns NULL if it is not a snapshot of
+   this very version and layout, or is not
+   consistent with itself, 'fr' otherwise
+ */
 static fr_t*
-init( int argc, char* argv[], fr_t* fr )
+loadStage( fr_t* fr, const char* path )
 {
-	int		n;
+	snapParams_t*	params;
+	uint64_t	size;
+	const char*	dialog;
+	int		i;
 
 
-	if ( argc < 3 )
+	if ( !mapSnap( &fr->snap, path, SNAP_VERSION ) )
 	{
 		return NULL;
 	}
 
-	fr->minInt = atoi( argv[ 1 ] );
-	if ( fr->minInt <= 0 )
+	params = ( snapParams_t* )snapSection( &fr->snap, SNAP_PARAMS, &size );
+	if ( !params || size != sizeof( snapParams_t ) ||
+		params->numSize != sizeof( num_t ) ||
+		params->stage < 0 || params->stage >= MAX_SAYS ||
+		params->nCols < 0 || params->nCols > INT_MAX ||
+		params->nRows < 0 || params->nRows >= ( int64_t )MAX_PRODUCT ||
+		params->nCells < 0 || params->nCells >= ( int64_t )MAX_PRODUCT )
 	{
 		return NULL;
 	}
 
-	fr->minSum = fr->minInt + fr->minInt;
-	fr->maxSum = atoi( argv[ 2 ] );
-	if ( fr->maxSum <= fr->minSum )
-	{
-		return NULL;
-	}
+	fr->minInt = params->minInt;
+	fr->maxInt = params->maxInt;
+	fr->minSum = params->minSum;
+	fr->maxSum = params->maxSum;
+	fr->nCols = params->nCols;
+	fr->nRows = params->nRows;
+	fr->nCells = params->nCells;
+	fr->dense = params->dense != 0;
+	fr->stage = params->stage;
+	fr->nColWords = ( fr->nCols + 63 ) / 64;
 
-	fr->maxInt = fr->maxSum - fr->minInt;
+	/*
+	   The dialog is the built-in
+	   one unless it is there
+	 */
+	dialog = ( const char* )snapSection( &fr->snap, SNAP_DIALOG, &size );
+	if ( dialog )
+	{
+		if ( size % 4 || size / 4 > MAX_SAYS )
+		{
+			return NULL;
+		}
 
+		fr->dialog = 1;
+		fr->nSays = ( int )( size / 4 );
+		for ( i = 0; i < fr->nSays; i++ )
+		{
+			fr->says[ i ].speaker = dialog[ 4 * i ];
+			fr->says[ i ].claim = dialog[ 4 * i + 1 ];
+			fr->says[ i ].loop = dialog[ 4 * i + 2 ];
+			fr->says[ i ].changed = dialog[ 4 * i + 3 ] != 0;
+		}
+	}
 
-	fr->nCols = fr->maxSum - fr->minSum + 1;
-	fr->cols = ( num_t* )calloc( fr->nCols, sizeof( num_t ) );
-	if ( !fr->cols )
+	if ( ( dialog ? compileDialog( fr ) : mkDialog( fr, NULL ) ) < 0 ||
+		fr->stage >= fr->nSays )
 	{
 		return NULL;
 	}
-	mkSums( fr );
-
-
-	/*
-	   Compute the upper bound for
-	   the number of legal products,
-	   including duplicates
-	 */
-	fr->nRows = mkProducts( fr );
+	fr->nRowWords = ( fr->nRows + 63 ) / 64;
 
-	fr->rows = ( num_t* )calloc( fr->nRows, sizeof( num_t ) );
-	if ( !fr->rows )
+	fr->cols = ( num_t* )stageArray( fr, SNAP_COLS,
+		( uint64_t )fr->nCols * sizeof( num_t ) );
+	fr->rows = ( num_t* )stageArray( fr, SNAP_ROWS,
+		( uint64_t )fr->nRows * sizeof( num_t ) );
+	if ( !fr->cols || !fr->rows )
 	{
 		return NULL;
 	}
 
-	/*
-	   Populate the actual products,
-	   including duplicates
-	 */
-	fr->nRows = mkProducts( fr );
-
-	rmDupProducts( fr );
-
-
-	n = fr->nCols * fr->nRows;
-	fr->matrix = ( char* )calloc( n, sizeof( char ) );
-	if ( !fr->matrix )
+	if ( fr->dense )
 	{
-		return NULL;
+		fr->bits = ( uint64_t* )stageArray( fr, SNAP_BITS,
+			( uint64_t )fr->nRows * fr->nColWords * sizeof( uint64_t ) );
+		fr->tbits = ( uint64_t* )stageArray( fr, SNAP_TBITS,
+			( uint64_t )fr->nCols * fr->nRowWords * sizeof( uint64_t ) );
+		fr->liveCols = ( uint64_t* )stageArray( fr, SNAP_LIVE_COLS,
+			( uint64_t )fr->nColWords * sizeof( uint64_t ) );
+		fr->liveRows = ( uint64_t* )stageArray( fr, SNAP_LIVE_ROWS,
+			( uint64_t )fr->nRowWords * sizeof( uint64_t ) );
+
+		return fr->bits && fr->tbits && fr->liveCols && fr->liveRows ?
+			fr : NULL;
 	}
 
-	mkMatrix( fr );
-
-	return fr;
+	fr->rowStart = ( idx_t* )stageArray( fr, SNAP_ROW_START,
+		( uint64_t )( fr->nRows + 1 ) * sizeof( idx_t ) );
+	fr->rowCols = ( int* )stageArray( fr, SNAP_ROW_COLS,
+		( uint64_t )fr->nCells * sizeof( int ) );
+	fr->colStart = ( idx_t* )stageArray( fr, SNAP_COL_START,
+		( uint64_t )( fr->nCols + 1 ) * sizeof( idx_t ) );
+	fr->colRows = ( idx_t* )stageArray( fr, SNAP_COL_ROWS,
+		( uint64_t )fr->nCells * sizeof( idx_t ) );
+
+	return fr->rowStart && fr->rowCols && fr->colStart && fr->colRows ?
+		fr : NULL;
 }
 
 
-static void
-mkSums( fr_t* fr )
+/*
+   The array 'id' of the snapshot, NULL if there
+   is none or it is not 'size' bytes long
+ */
+static void*
+stageArray( fr_t* fr, uint32_t id, uint64_t size )
 {
-	int		sum;
-	int		col;
+	void*		p;
+	uint64_t	actual;
 
 
-	/*
-	   The array of sums is automatically
-	   sorted in the ascending order
-	 */
-	for ( sum = fr->minSum, col = 0; sum <= fr->maxSum; sum++, col++ )
-	{
-		fr->cols[ col ].num = sum;
-		fr->cols[ col ].live = 1;
-	}
+	p = snapSection( &fr->snap, id, &actual );
+
+	return p && actual == size ? p : NULL;
 }
 
 
-static int
-mkProducts( fr_t* fr )
+/*
+   Print the heading of the stage at hand
+   followed by as much of its survivors as
+   asked for
+
+   The matrix of a fused statement is the
+   one before it, only the very first one
+   is printed, as the initial matrix
+ */
+static void
+printRound( fr_t* fr )
 {
-	int		a;
-	int		b;
-	int		sum;
-	int		prod;
-	int		nprods;
-	int		ubound = 0;
-	int		actual = 0;
+	say_t*		say = &fr->says[ fr->stage ];
 
 
-	for ( a = fr->minInt; a <= fr->maxInt; a++ )
+	if ( fr->verbose == VERBOSE_ANSWERS || ( say->fused && fr->stage > 0 ) )
 	{
-		for ( b = a + 1; b <= fr->maxInt; b++ )
-		{
-			sum = a + b;
-
-			if ( sum > fr->maxSum )
-			{
-				continue;
-			}
-
-			if ( !fr->rows )
-			{
-				ubound++;
-				continue;
-			}
-
-			prod = a * b;
-			fr->rows[ actual ].num = prod;
-			fr->rows[ actual ].live = 1;
-			actual++;
-		}
+		return;
 	}
 
-	if ( !fr->rows )
+	if ( say->fused )
 	{
-		nprods = ubound;
+		outStr( &fr->out, "Initial matrix:\n" );
 	}
 	else
 	{
-		nprods = actual;
+		outStr( &fr->out, fr->stage > 0 ? "\nSurvivors of \"" :
+			"Survivors of \"" );
+		outStr( &fr->out, say->name );
+		outStr( &fr->out, ": " );
+		outStr( &fr->out, say->phrase );
+		outStr( &fr->out, "\":\n" );
 	}
 
-	return nprods;
+	if ( fr->verbose == VERBOSE_COUNTS )
+	{
+		printCounts( fr );
+		return;
+	}
+
+	printFr( fr );
 }
 
 
+/*
+   The number of the live sums and that of the
+   live products, those with a live sum left -
+   the columns and the rows printFr() prints
+ */
 static void
-rmDupProducts( fr_t* fr )
+printCounts( fr_t* fr )
 {
-	num_t*		found;
-	num_t		key;
-	int		row;
-	size_t		n;
-
-
-	qsort( fr->rows, fr->nRows, sizeof( num_t ), cmpNums );
+	int		ncols;
+	idx_t		nrows;
 
-	for ( row = 0; row < fr->nRows; row++ )
-	{
-		key.num = fr->rows[ row ].num;
 
-		while ( 1 )
-		{
-			found = bsearch( &key,
-				fr->rows + row + 1,
-				fr->nRows - ( row + 1 ),
-				sizeof( num_t ),
-				cmpNums );
-			if ( !found )
-			{
-				break;
-			}
+	countLive( fr, &ncols, &nrows );
 
-			/*
-			   Found duplicate is moved into
-			   the place of the current product
-			 */
-			n = ( fr->nRows - ( row + 1 ) ) * sizeof( num_t );
-			memmove( fr->rows + row, found, n );
-			fr->nRows--;
-		}
-	}
+	outStr( &fr->out, "sums = " );
+	outInt( &fr->out, ncols );
+	outStr( &fr->out, ", products = " );
+	outInt( &fr->out, nrows );
+	outChar( &fr->out, '\n' );
 }
 
 
 /*
-   For each product (row):
-
-   decompose the current product into all
-   possible pairs of factors, for each
-   pair of factors:
-
-      set the value in the matrix's cell
-      (in the current row) in the column
-      corresponding to the sum to which
-      these two factor add to to 1
+   The live sums, and the live products
+   that still have a live sum
  */
 static void
-mkMatrix( fr_t* fr )
+countLive( fr_t* fr, int* ncols, idx_t* nrows )
 {
-	int		a;
-	int		b;
+	idx_t		row;
 	int		col;
-	int		row;
-	int		product;
-	int		sqroot;
-	int		sum;
-	num_t		key;
-	num_t*		found;
+	char		liveOnly = 1;
 
 
-	for ( row = 0; row < fr->nRows; row++ )
+	*ncols = 0;
+	for ( col = 0; col < fr->nCols; col++ )
 	{
-		product = fr->rows[ row ].num;
-		sqroot = ( int )sqrt( ( double )product );
+		*ncols += fr->cols[ col ].live;
+	}
 
-		for( a = 2; a <= sqroot; a++ )
+	*nrows = 0;
+	for ( row = 0; row < fr->nRows; row++ )
+	{
+		if ( fr->rows[ row ].live && nSums( fr, row, liveOnly, NULL ) > 0 )
 		{
-			if ( product % a != 0 )
-			{
-				continue;
-			}
-
-			b = product / a;
-			sum = a + b;
-			key.num = sum;
-			found = bsearch( &key, fr->cols, fr->nCols,
-				sizeof( num_t ), cmpNums );
-			if ( !found )
-			{
-				continue;
-			}
-
-			col = found - fr->cols;
-			*( fr->matrix + row * fr->nCols + col ) = 1;
+			( *nrows )++;
 		}
 	}
 }
@@ -640,22 +3781,31 @@ mkMatrix( fr_t* fr )
 static void
 printFr( fr_t* fr )
 {
-	char		v;
-	int		row;
+	idx_t		i;
+	idx_t		end;
+	idx_t		row;
 	int		col;
 	int		nsums;
 	char		liveOnly = 1;
+	out_t*		out = &fr->out;
 
 
-	printf( "minInt = %d, maxInt = %d\n"
-		"minSum = %d, maxSum = %d\n"
-		"nCols = %d, nRows = %d\n",
-		fr->minInt, fr->maxInt,
-		fr->minSum, fr->maxSum,
-		fr->nCols, fr->nRows );
+	outStr( out, "minInt = " );
+	outInt( out, fr->minInt );
+	outStr( out, ", maxInt = " );
+	outInt( out, fr->maxInt );
+	outStr( out, "\nminSum = " );
+	outInt( out, fr->minSum );
+	outStr( out, ", maxSum = " );
+	outInt( out, fr->maxSum );
+	outStr( out, "\nnCols = " );
+	outInt( out, fr->nCols );
+	outStr( out, ", nRows = " );
+	outInt( out, fr->nRows );
+	outChar( out, '\n' );
 
 
-	printf( "\t" );
+	outChar( out, '\t' );
 	for ( col = 0; col < fr->nCols; col++ )
 	{
 		if ( !fr->cols[ col ].live )
@@ -663,9 +3813,10 @@ printFr( fr_t* fr )
 			continue;
 		}
 
-		printf( "%d\t", fr->cols[ col ] );
+		outInt( out, fr->cols[ col ].num );
+		outChar( out, '\t' );
 	}
-	printf( "\n" );
+	outChar( out, '\n' );
 
 
 	for ( row = 0; row < fr->nRows; row++ )
@@ -681,20 +3832,49 @@ printFr( fr_t* fr )
 			continue;
 		}
 
-		printf( "%d\t", fr->rows[ row ].num );
+		outInt( out, fr->rows[ row ].num );
+		outChar( out, '\t' );
+
+		if ( fr->dense )
+		{
+			for ( col = 0; col < fr->nCols; col++ )
+			{
+				if ( !fr->cols[ col ].live )
+				{
+					continue;
+				}
+
+				outChar( out, ( fr->bits[ ( size_t )row *
+					fr->nColWords + ( col >> 6 ) ] >>
+					( col & 63 ) ) & 1 ? '1' : ' ' );
+				outChar( out, '\t' );
+			}
+			outChar( out, '\n' );
+			continue;
+		}
 
+		/*
+		   Merge the row's sparse cells
+		   with the live columns
+		 */
+		i = fr->rowStart[ row ];
+		end = rowEnd( fr, row );
 		for ( col = 0; col < fr->nCols; col++ )
 		{
+			while ( i < end && fr->rowCols[ i ] < col )
+			{
+				i++;
+			}
+
 			if ( !fr->cols[ col ].live )
 			{
 				continue;
 			}
 
-			v = *( fr->matrix + row * fr->nCols + col );
-			printf( "%c\t",
-				v == 1 ? '1' : ' ' );
+			outChar( out, i < end && fr->rowCols[ i ] == col ? '1' : ' ' );
+			outChar( out, '\t' );
 		}
-		printf( "\n" );
+		outChar( out, '\n' );
 	}
 }
 
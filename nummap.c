@@ -0,0 +1,86 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "nummap.h"
+
+
+extern nummap_t*
+mkDenseMap( nummap_t* map, prod_t min, prod_t max )
+{
+	memset( map, 0, sizeof( nummap_t ) );
+
+	map->min = min;
+	map->max = max;
+	map->n = ( idx_t )( max - min + 1 );
+
+	return map;
+}
+
+
+/*
+   Returns NULL if the bitmap can not
+   be had, the empty map otherwise
+ */
+extern nummap_t*
+mkSparseMap( nummap_t* map, prod_t min, prod_t max )
+{
+	memset( map, 0, sizeof( nummap_t ) );
+
+	map->min = min;
+	map->max = max;
+	map->nWords = ( max - min ) / 64 + 1;
+
+	map->bits = ( uint64_t* )calloc( map->nWords, sizeof( uint64_t ) );
+	map->ranks = ( idx_t* )malloc( map->nWords * sizeof( idx_t ) );
+	if ( !map->bits || !map->ranks )
+	{
+		rmNumMap( map );
+		return NULL;
+	}
+
+	return map;
+}
+
+
+extern void
+rmNumMap( nummap_t* map )
+{
+	if ( map->bits )
+	{
+		free( map->bits );
+	}
+
+	if ( map->ranks )
+	{
+		free( map->ranks );
+	}
+
+	memset( map, 0, sizeof( nummap_t ) );
+}
+
+
+/*
+   Counts the values ahead of each word,
+   returns the number of all of them
+ */
+extern idx_t
+numMapSeal( nummap_t* map )
+{
+	prod_t		w;
+	idx_t		n = 0;
+
+
+	if ( !map->bits )
+	{
+		return map->n;
+	}
+
+	for ( w = 0; w < map->nWords; w++ )
+	{
+		map->ranks[ w ] = n;
+		n += __builtin_popcountll( map->bits[ w ] );
+	}
+	map->n = n;
+
+	return n;
+}
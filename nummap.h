@@ -0,0 +1,101 @@
+#ifndef NUMMAP_H
+#define NUMMAP_H
+
+#include <stdint.h>
+
+#include "primes.h"
+#include "pairs.h"
+
+
+/*
+   Maps a value of the matrix's headers - a sum
+   or a product, both kept in the ascending order
+   - to its index in the header
+
+   A dense map covers every value from 'min' up
+   to 'max': the index is the value less 'min',
+   which is how the sums go
+
+   A sparse map holds a set of such values, as
+   the products go: a bitmap with a bit per value
+   from 'min' up to 'max', and the number of the
+   values ahead of each of its 64-bit words. The
+   index of a value is that number and the bits
+   set ahead of it within its word, a popcount;
+   it takes two bits per value in range
+
+   The values are put in with numMapAdd() and the
+   map is sealed with numMapSeal() before it is
+   looked up
+ */
+typedef struct
+{
+	prod_t		min;
+	prod_t		max;
+	idx_t		n; /* is the number of the values */
+
+	uint64_t*	bits; /* NULL in a dense map */
+	idx_t*		ranks; /* per word of 'bits' */
+	prod_t		nWords;
+} nummap_t;
+
+
+extern nummap_t*	mkDenseMap( nummap_t*, prod_t, prod_t );
+extern nummap_t*	mkSparseMap( nummap_t*, prod_t, prod_t );
+extern void		rmNumMap( nummap_t* );
+extern idx_t		numMapSeal( nummap_t* );
+
+
+/*
+   The number of bytes a sparse map
+   of the range would take
+ */
+static inline prod_t
+sparseMapSize( prod_t min, prod_t max )
+{
+	return ( ( max - min ) / 64 + 1 ) * ( prod_t )( sizeof( uint64_t ) +
+		sizeof( idx_t ) );
+}
+
+
+static inline void
+numMapAdd( nummap_t* map, prod_t v )
+{
+	v -= map->min;
+	map->bits[ v >> 6 ] |= ( uint64_t )1 << ( v & 63 );
+}
+
+
+/*
+   Returns the index of 'v', -1 if
+   it is not in the map
+ */
+static inline idx_t
+numMapIndex( const nummap_t* map, prod_t v )
+{
+	uint64_t	word;
+
+
+	if ( v < map->min || v > map->max )
+	{
+		return -1;
+	}
+
+	v -= map->min;
+	if ( !map->bits )
+	{
+		return ( idx_t )v;
+	}
+
+	word = map->bits[ v >> 6 ];
+	if ( !( word & ( ( uint64_t )1 << ( v & 63 ) ) ) )
+	{
+		return -1;
+	}
+
+	return map->ranks[ v >> 6 ] +
+		__builtin_popcountll( word & ( ( ( uint64_t )1 << ( v & 63 ) ) - 1 ) );
+}
+
+
+#endif
@@ -0,0 +1,375 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "out.h"
+
+
+/*
+   The block an out_t with a file descriptor
+   writes at a time, and the size an out_t
+   without one starts out with
+ */
+#define OUT_BLOCK	( 1 << 20 )
+#define OUT_START	4096
+
+/*
+   The most buffers outVec() hands
+   to a single writev()
+ */
+#define OUT_IOV		64
+
+
+static int		writeVec( int, struct iovec*, int );
+
+
+/*
+   Returns NULL if the buffer can
+   not be had, 'out' otherwise
+ */
+extern out_t*
+mkOut( out_t* out, int fd )
+{
+	memset( out, 0, sizeof( out_t ) );
+
+	out->fd = fd;
+	out->size = fd >= 0 ? OUT_BLOCK : OUT_START;
+	out->p = ( char* )malloc( out->size );
+	if ( !out->p )
+	{
+		return NULL;
+	}
+
+	return out;
+}
+
+
+/*
+   Write out whatever is left, and let go
+   of the buffer (not of the descriptor)
+
+   Returns -1 if any of the output has
+   been lost along the way, 0 otherwise
+ */
+extern int
+rmOut( out_t* out )
+{
+	int		rv;
+
+
+	outFlush( out );
+	rv = out->failed ? -1 : 0;
+
+	if ( out->p )
+	{
+		free( out->p );
+	}
+
+	memset( out, 0, sizeof( out_t ) );
+	out->fd = -1;
+
+	return rv;
+}
+
+
+/*
+   Make room for 'n' more bytes: write the
+   block out or, without a file descriptor,
+   grow it
+
+   Returns 0, -1 if the room can not be had
+ */
+extern int
+outRoom( out_t* out, size_t n )
+{
+	size_t		size;
+	char*		p;
+
+
+	if ( out->size - out->len >= n )
+	{
+		return 0;
+	}
+
+	if ( out->fd >= 0 )
+	{
+		outFlush( out );
+		return out->size - out->len >= n ? 0 : -1;
+	}
+
+	size = out->size ? out->size * 2 : OUT_START;
+	while ( size - out->len < n )
+	{
+		size *= 2;
+	}
+
+	p = ( char* )realloc( out->p, size );
+	if ( !p )
+	{
+		out->failed = 1;
+		return -1;
+	}
+
+	out->p = p;
+	out->size = size;
+
+	return 0;
+}
+
+
+/*
+   Returns 0, -1 if the write failed
+   (the block is dropped all the same)
+ */
+extern int
+outFlush( out_t* out )
+{
+	struct iovec	iov;
+	int		rv;
+
+
+	if ( out->fd < 0 || out->len == 0 )
+	{
+		return 0;
+	}
+
+	iov.iov_base = out->p;
+	iov.iov_len = out->len;
+	rv = writeVec( out->fd, &iov, 1 );
+	out->len = 0;
+
+	if ( rv < 0 )
+	{
+		out->failed = 1;
+	}
+
+	return rv;
+}
+
+
+extern void
+outBytes( out_t* out, const char* s, size_t n )
+{
+	struct iovec	iov;
+
+
+	if ( out->size - out->len < n && out->fd >= 0 )
+	{
+		outFlush( out );
+
+		/*
+		   Too big for the block:
+		   straight through
+		 */
+		if ( n > out->size )
+		{
+			iov.iov_base = ( void* )s;
+			iov.iov_len = n;
+			if ( writeVec( out->fd, &iov, 1 ) < 0 )
+			{
+				out->failed = 1;
+			}
+			return;
+		}
+	}
+
+	if ( outRoom( out, n ) < 0 )
+	{
+		return;
+	}
+
+	memcpy( out->p + out->len, s, n );
+	out->len += n;
+}
+
+
+extern void
+outStr( out_t* out, const char* s )
+{
+	outBytes( out, s, strlen( s ) );
+}
+
+
+/*
+   The digits are laid out from the last one
+   up in a scratch buffer, then copied over
+ */
+extern void
+outInt( out_t* out, long long v )
+{
+	char		digits[ 24 ];
+	char*		d = digits + sizeof( digits );
+	unsigned long long	u = v < 0 ? -( unsigned long long )v :
+		( unsigned long long )v;
+
+
+	do
+	{
+		*--d = '0' + u % 10;
+		u /= 10;
+	}
+	while ( u );
+
+	if ( v < 0 )
+	{
+		*--d = '-';
+	}
+
+	outBytes( out, d, digits + sizeof( digits ) - d );
+}
+
+
+/*
+   Write out whatever 'out' holds followed by
+   the contents of 'n' out_t's without a file
+   descriptor, in their order, handing them to
+   writev() a batch at a time, which leaves
+   the 'n' of them empty
+
+   Without a file descriptor of its own 'out'
+   keeps them all instead
+
+   Returns 0, -1 if a write failed
+ */
+extern int
+outVec( out_t* out, out_t* outs, int n )
+{
+	struct iovec	iov[ OUT_IOV ];
+	int		cnt = 0;
+	int		i;
+	int		rv = 0;
+
+
+	if ( out->fd < 0 )
+	{
+		for ( i = 0; i < n; i++ )
+		{
+			outBytes( out, outs[ i ].p, outs[ i ].len );
+			outs[ i ].len = 0;
+		}
+
+		return out->failed ? -1 : 0;
+	}
+
+	if ( out->len > 0 )
+	{
+		iov[ cnt ].iov_base = out->p;
+		iov[ cnt ].iov_len = out->len;
+		cnt++;
+	}
+
+	for ( i = 0; i < n; i++ )
+	{
+		if ( outs[ i ].len == 0 )
+		{
+			continue;
+		}
+
+		if ( cnt == OUT_IOV )
+		{
+			if ( writeVec( out->fd, iov, cnt ) < 0 )
+			{
+				rv = -1;
+			}
+			cnt = 0;
+		}
+
+		iov[ cnt ].iov_base = outs[ i ].p;
+		iov[ cnt ].iov_len = outs[ i ].len;
+		cnt++;
+	}
+
+	if ( cnt > 0 && writeVec( out->fd, iov, cnt ) < 0 )
+	{
+		rv = -1;
+	}
+
+	out->len = 0;
+	for ( i = 0; i < n; i++ )
+	{
+		outs[ i ].len = 0;
+	}
+
+	if ( rv < 0 )
+	{
+		out->failed = 1;
+	}
+
+	return rv;
+}
+
+
+/*
+   writev() all of 'iov', picking up
+   where a short write leaves off
+
+   Returns 0, -1 on an error
+ */
+static int
+writeVec( int fd, struct iovec* iov, int cnt )
+{
+	ssize_t		n;
+
+
+	while ( cnt > 0 )
+	{
+		n = writev( fd, iov, cnt );
+		if ( n < 0 )
+		{
+			if ( errno == EINTR )
+			{
+				continue;
+			}
+
+			return -1;
+		}
+
+		while ( cnt > 0 && ( size_t )n >= iov->iov_len )
+		{
+			n -= iov->iov_len;
+			iov++;
+			cnt--;
+		}
+
+		if ( cnt > 0 )
+		{
+			iov->iov_base = ( char* )iov->iov_base + n;
+			iov->iov_len -= n;
+		}
+	}
+
+	return 0;
+}
+
+
+/*
+   Tell why a run can not go on, or what it
+   leaves out: a line of 'who', 'what' and,
+   unless it is NULL, the 'arg' that 'what'
+   is about, onto stderr
+ */
+extern void
+outErr( const char* who, const char* what, const char* arg )
+{
+	out_t		err;
+
+
+	if ( !mkOut( &err, STDERR_FILENO ) )
+	{
+		return;
+	}
+
+	outStr( &err, who );
+	outStr( &err, ": " );
+	outStr( &err, what );
+	if ( arg )
+	{
+		outStr( &err, ": " );
+		outStr( &err, arg );
+	}
+	outChar( &err, '\n' );
+
+	rmOut( &err );
+}
@@ -0,0 +1,63 @@
+#ifndef OUT_H
+#define OUT_H
+
+#include <stddef.h>
+
+
+/*
+   Buffered output shared by both solvers
+
+   Whatever is printed piles up in a large block
+   which is written to the file descriptor 'fd' once
+   it fills up, stdio is not involved; the integers
+   are formatted by hand
+
+   An out_t with no file descriptor ('fd' is -1)
+   keeps it all instead, growing as needed, for
+   outVec() to write out later - a few of them
+   at once, with a single writev()
+ */
+typedef struct
+{
+	int		fd; /* -1 to keep it all */
+	char*		p;
+	size_t		len;
+	size_t		size;
+	char		failed; /* a write or an allocation did */
+} out_t;
+
+
+/*
+   How much the solvers print: the answers alone,
+   the survivor counts of every round along with
+   them, or all the survivors
+ */
+#define VERBOSE_ANSWERS		0
+#define VERBOSE_COUNTS		1
+#define VERBOSE_FULL		2
+
+
+extern out_t*		mkOut( out_t*, int );
+extern int		rmOut( out_t* );
+extern int		outRoom( out_t*, size_t );
+extern int		outFlush( out_t* );
+extern void		outBytes( out_t*, const char*, size_t );
+extern void		outStr( out_t*, const char* );
+extern void		outInt( out_t*, long long );
+extern int		outVec( out_t*, out_t*, int );
+extern void		outErr( const char*, const char*, const char* );
+
+
+static inline void
+outChar( out_t* out, char c )
+{
+	if ( out->len == out->size && outRoom( out, 1 ) < 0 )
+	{
+		return;
+	}
+
+	out->p[ out->len++ ] = c;
+}
+
+
+#endif
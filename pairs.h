@@ -0,0 +1,99 @@
+#ifndef PAIRS_H
+#define PAIRS_H
+
+#include <stdint.h>
+
+#include "primes.h"
+
+
+/*
+   A pair - and a product's row or a cell of
+   cfreudenthal's matrix, of which there are
+   as many - is had by its index, which goes
+   past an int once 'maxSum' is past 92,684
+   with 'minInt' at 2
+ */
+typedef int64_t		idx_t;
+
+
+/*
+   The pairs of numbers both solvers go through:
+   x < y, both no less than 'minInt', that add up
+   to no more than 'maxSum'
+
+   Their number is had in closed form: for each
+   x from 'minInt' up to ( 'maxSum' - 1 ) / 2 there
+   are 'maxSum' - 2x of them, which adds up to the
+   below. 'minInt' is at least 1
+ */
+static inline long long
+nPairs( int minInt, int maxSum )
+{
+	long long	hi = ( maxSum - 1 ) / 2; /* is the largest x */
+	long long	n = hi - minInt + 1;
+
+
+	return n > 0 ? n * maxSum - ( minInt + hi ) * n : 0;
+}
+
+
+/*
+   The pairs x = y within the
+   same bounds, the squares
+ */
+static inline long long
+nSquares( int minInt, int maxSum )
+{
+	long long	n = maxSum / 2 - minInt + 1;
+
+
+	return n > 0 ? n : 0;
+}
+
+
+/*
+   The pairs are ordered by x, then by y: the
+   pairs ahead of those of x = 'minInt' + k are
+   k * ( c - k ), c being 'maxSum' - 2 'minInt' + 1
+
+   pairIndex() is the place of the pair ( 'x', 'y' )
+   in that order, pairAt() is the pair at 'index'
+   found by solving the above for k. Either takes
+   O(1), so that any range of the pairs can be laid
+   out on its own, a thread per range
+ */
+static inline long long
+pairIndex( int minInt, int maxSum, int x, int y )
+{
+	long long	c = ( long long )maxSum - 2 * minInt + 1;
+	long long	k = x - minInt;
+
+
+	return k * ( c - k ) + ( y - x - 1 );
+}
+
+
+static inline void
+pairAt( int minInt, int maxSum, long long index, int* x, int* y )
+{
+	long long	c = ( long long )maxSum - 2 * minInt + 1;
+	long long	k;
+
+
+	k = ( c - ( long long )isqrt64( ( prod_t )( c * c - 4 * index ) ) ) / 2;
+	while ( k > 0 && k * ( c - k ) > index )
+	{
+		k--;
+	}
+
+	while ( ( k + 1 ) * ( c - k - 1 ) <= index )
+	{
+		k++;
+	}
+
+	*x = minInt + ( int )k;
+	*y = *x + 1 + ( int )( index - k * ( c - k ) );
+}
+
+
+#endif
@@ -0,0 +1,219 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+
+
+/*
+   Every thread gets this many chunks
+   to go by, to even out the load
+ */
+#define CHUNKS_PER_THREAD	16
+
+
+static void*		worker( void* );
+static void		runChunks( pool_t*, int );
+
+
+/*
+   Start 'nThreads' - 1 workers, the caller
+   of runPool() is the last one
+
+   Returns NULL if they can not be had,
+   'pool' otherwise
+ */
+extern pool_t*
+mkPool( pool_t* pool, int nThreads )
+{
+	int		i;
+
+
+	memset( pool, 0, sizeof( pool_t ) );
+
+	if ( nThreads < 1 )
+	{
+		nThreads = 1;
+	}
+	pool->nThreads = 1;
+
+	pthread_mutex_init( &pool->lock, NULL );
+	pthread_cond_init( &pool->go, NULL );
+	pthread_cond_init( &pool->done, NULL );
+
+	if ( nThreads == 1 )
+	{
+		return pool;
+	}
+
+	pool->threads = ( pthread_t* )calloc( nThreads - 1, sizeof( pthread_t ) );
+	if ( !pool->threads )
+	{
+		rmPool( pool );
+		return NULL;
+	}
+
+	for ( i = 0; i < nThreads - 1; i++ )
+	{
+		if ( pthread_create( &pool->threads[ i ], NULL, worker, pool ) )
+		{
+			rmPool( pool );
+			return NULL;
+		}
+
+		pool->nThreads++;
+	}
+
+	return pool;
+}
+
+
+/*
+   Stop and reap the workers
+ */
+extern void
+rmPool( pool_t* pool )
+{
+	int		i;
+
+
+	pthread_mutex_lock( &pool->lock );
+	pool->quit = 1;
+	pthread_cond_broadcast( &pool->go );
+	pthread_mutex_unlock( &pool->lock );
+
+	for ( i = 0; i < pool->nThreads - 1; i++ )
+	{
+		pthread_join( pool->threads[ i ], NULL );
+	}
+
+	if ( pool->threads )
+	{
+		free( pool->threads );
+	}
+
+	pthread_cond_destroy( &pool->done );
+	pthread_cond_destroy( &pool->go );
+	pthread_mutex_destroy( &pool->lock );
+
+	memset( pool, 0, sizeof( pool_t ) );
+}
+
+
+/*
+   Run 'task' over 0..'n' - 1 on all the
+   threads and return once it is all done
+ */
+extern void
+runPool( pool_t* pool, task_t task, void* arg, int64_t n )
+{
+	if ( pool->nThreads <= 1 )
+	{
+		task( arg, 0, n, 0 );
+		return;
+	}
+
+	pthread_mutex_lock( &pool->lock );
+
+	pool->task = task;
+	pool->arg = arg;
+	pool->n = n;
+	pool->chunk = n / ( pool->nThreads * CHUNKS_PER_THREAD );
+	if ( pool->chunk < 1 )
+	{
+		pool->chunk = 1;
+	}
+	pool->next = 0;
+	pool->busy = pool->nThreads - 1;
+	pool->generation++;
+
+	pthread_cond_broadcast( &pool->go );
+	pthread_mutex_unlock( &pool->lock );
+
+
+	runChunks( pool, 0 );
+
+
+	pthread_mutex_lock( &pool->lock );
+	while ( pool->busy > 0 )
+	{
+		pthread_cond_wait( &pool->done, &pool->lock );
+	}
+	pthread_mutex_unlock( &pool->lock );
+}
+
+
+static void*
+worker( void* arg )
+{
+	pool_t*		pool = ( pool_t* )arg;
+	unsigned	seen = 0; /* no loop has been run before the pool */
+	int		thread;
+
+
+	pthread_mutex_lock( &pool->lock );
+	thread = ++pool->started;
+	pthread_mutex_unlock( &pool->lock );
+
+	while ( 1 )
+	{
+		pthread_mutex_lock( &pool->lock );
+		while ( pool->generation == seen && !pool->quit )
+		{
+			pthread_cond_wait( &pool->go, &pool->lock );
+		}
+
+		if ( pool->quit )
+		{
+			pthread_mutex_unlock( &pool->lock );
+			return NULL;
+		}
+
+		seen = pool->generation;
+		pthread_mutex_unlock( &pool->lock );
+
+
+		runChunks( pool, thread );
+
+
+		pthread_mutex_lock( &pool->lock );
+		if ( --pool->busy == 0 )
+		{
+			pthread_cond_signal( &pool->done );
+		}
+		pthread_mutex_unlock( &pool->lock );
+	}
+}
+
+
+/*
+   Keep grabbing the next chunk of the
+   current loop until there is none left
+
+   Every thread grabs one chunk past the
+   end: 'next' goes as high as 'n' plus a
+   chunk per thread, hence its 64 bits
+ */
+static void
+runChunks( pool_t* pool, int thread )
+{
+	int64_t		lo;
+	int64_t		hi;
+
+
+	while ( 1 )
+	{
+		lo = __atomic_fetch_add( &pool->next, pool->chunk, __ATOMIC_RELAXED );
+		if ( lo >= pool->n )
+		{
+			break;
+		}
+
+		hi = lo + pool->chunk;
+		if ( hi > pool->n )
+		{
+			hi = pool->n;
+		}
+
+		pool->task( pool->arg, lo, hi, thread );
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+
+/*
+   A pool of worker threads shared by both solvers
+
+   The threads are started once and then take
+   part in every parallel loop run by runPool():
+   the loop's range 0..'n' - 1, 64-bit for it to
+   cover all the pairs, is cut into chunks
+   which the workers, and the caller with them,
+   grab one after another until none is left
+
+   A task is handed its argument, the chunk's
+   bounds 'lo' (inclusive) and 'hi' (exclusive)
+   and the number of the thread running it,
+   0 through 'nThreads' - 1 (0 is the caller),
+   to pick its own scratch space by
+ */
+typedef void		( *task_t )( void*, int64_t, int64_t, int );
+
+typedef struct
+{
+	int		nThreads; /* including the caller */
+	pthread_t*	threads; /* 'nThreads' - 1 workers */
+	pthread_mutex_t	lock;
+	pthread_cond_t	go;
+	pthread_cond_t	done;
+	unsigned	generation; /* is bumped for every loop */
+	int		started; /* workers up so far */
+	int		busy; /* workers still on the current loop */
+	int		quit;
+
+	task_t		task; /* the current loop */
+	void*		arg;
+	int64_t		n;
+	int64_t		chunk;
+	int64_t		next; /* is the start of the next chunk, past 'n' at the end */
+} pool_t;
+
+
+extern pool_t*		mkPool( pool_t*, int );
+extern void		rmPool( pool_t* );
+extern void		runPool( pool_t*, task_t, void*, int64_t );
+
+
+#endif
@@ -0,0 +1,903 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#include "primes.h"
+
+
+/*
+   The number of odd numbers sieved at a time:
+   their bits take 32K, which fits in L1
+ */
+#define SEGMENT_BITS	( 1 << 18 )
+
+
+static int		isqrt( int );
+static int		mkBasePrimes( int, int** );
+static void		sieveSegment( sieve_t*, int*, int, int, int );
+static int		mkPrimes( sieve_t* );
+static int		mkSpf( sieve_t* );
+static void		addFactor( factors_t*, int );
+static void		addFactor64( factors64_t*, prod_t );
+static int		divisorPairs( factors64_t*, prod_t, prod_t* );
+static int		cmpProds( const void*, const void* );
+
+
+/*
+   Sieve all the numbers up to 'limit' and, if
+   'withSpf' is set, record the smallest prime
+   factor of each one of them
+
+   Returns NULL if any of the memory can not
+   be had, 'sv' otherwise
+ */
+extern sieve_t*
+mkSieve( sieve_t* sv, int limit, int withSpf )
+{
+	int		lo;
+	int		hi;
+	int		nodd;
+	int		nwords;
+	int		nbase;
+	int*		base = NULL;
+
+
+	memset( sv, 0, sizeof( sieve_t ) );
+
+	if ( limit < 2 )
+	{
+		limit = 2;
+	}
+	sv->limit = limit;
+
+
+	/*
+	   Bit 'i' stands for the odd number 2 * 'i' + 1,
+	   all of them are prime until proven otherwise
+	   and 1 is not
+	 */
+	nodd = limit / 2 + 1;
+	nwords = ( nodd + 63 ) / 64;
+	sv->odd = ( uint64_t* )malloc( nwords * sizeof( uint64_t ) );
+	if ( !sv->odd )
+	{
+		goto fail;
+	}
+	memset( sv->odd, 0xff, nwords * sizeof( uint64_t ) );
+	sv->odd[ 0 ] &= ~( uint64_t )1;
+
+
+	nbase = mkBasePrimes( isqrt( limit ), &base );
+	if ( nbase < 0 )
+	{
+		goto fail;
+	}
+
+	for ( lo = 0; lo < nodd; lo += SEGMENT_BITS )
+	{
+		hi = lo + SEGMENT_BITS;
+		if ( hi > nodd )
+		{
+			hi = nodd;
+		}
+
+		sieveSegment( sv, base, nbase, lo, hi );
+	}
+
+	free( base );
+	base = NULL;
+
+
+	/*
+	   Clear the bits past 'limit' so that
+	   they never count as primes
+	 */
+	for ( lo = limit / 2; lo < nwords * 64; lo++ )
+	{
+		if ( 2 * lo + 1 > limit )
+		{
+			sv->odd[ lo >> 6 ] &= ~( ( uint64_t )1 << ( lo & 63 ) );
+		}
+	}
+
+	if ( mkPrimes( sv ) < 0 )
+	{
+		goto fail;
+	}
+
+	if ( withSpf && mkSpf( sv ) < 0 )
+	{
+		goto fail;
+	}
+
+	return sv;
+
+fail:
+	if ( base )
+	{
+		free( base );
+	}
+
+	rmSieve( sv );
+
+	return NULL;
+}
+
+
+extern void
+rmSieve( sieve_t* sv )
+{
+	if ( sv->odd )
+	{
+		free( sv->odd );
+	}
+
+	if ( sv->primes )
+	{
+		free( sv->primes );
+	}
+
+	if ( sv->spf )
+	{
+		free( sv->spf );
+	}
+
+	memset( sv, 0, sizeof( sieve_t ) );
+}
+
+
+/*
+   The slow path of isPrime() for an odd 'n'
+   beyond the sieve: try it against the sieved
+   primes, they suffice as long as 'n' does not
+   exceed 'limit' squared
+ */
+extern int
+isPrimeBeyond( sieve_t* sv, int n )
+{
+	int		i;
+	int		p;
+	int		sqroot = isqrt( n );
+
+
+	for ( i = 0; i < sv->nPrimes; i++ )
+	{
+		p = sv->primes[ i ];
+		if ( p > sqroot )
+		{
+			return 1;
+		}
+
+		if ( n % p == 0 )
+		{
+			return 0;
+		}
+	}
+
+	/*
+	   Out of the sieved primes: carry
+	   on with the odd numbers past them
+	 */
+	for ( p = sv->limit | 1; p <= sqroot; p += 2 )
+	{
+		if ( n % p == 0 )
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+
+/*
+   Break 'n' down into its prime factors, by the
+   smallest prime factor table while 'n' is within
+   the sieve and by trial division with the sieved
+   primes until it is (or all the way, if the sieve
+   has no such table)
+
+   Returns the number of prime factors counted
+   with their multiplicity, 0 for 'n' below 2
+ */
+extern int
+factorize( sieve_t* sv, int n, factors_t* f )
+{
+	int		i;
+	int		p;
+	int		omega = 0;
+
+
+	f->n = 0;
+
+	if ( n < 2 )
+	{
+		return 0;
+	}
+
+	while ( !( n & 1 ) )
+	{
+		addFactor( f, 2 );
+		n >>= 1;
+		omega++;
+	}
+
+	for ( i = 1; ( n > sv->limit || !sv->spf ) && i < sv->nPrimes; i++ )
+	{
+		p = sv->primes[ i ];
+		if ( ( long long )p * p > n )
+		{
+			break;
+		}
+
+		while ( n % p == 0 )
+		{
+			addFactor( f, p );
+			n /= p;
+			omega++;
+		}
+	}
+
+	for ( p = sv->limit | 1; n > sv->limit && ( long long )p * p <= n; p += 2 )
+	{
+		while ( n % p == 0 )
+		{
+			addFactor( f, p );
+			n /= p;
+			omega++;
+		}
+	}
+
+	if ( n > sv->limit || !sv->spf )
+	{
+		/*
+		   Whatever is left over is a prime
+		 */
+		if ( n > 1 )
+		{
+			addFactor( f, n );
+			omega++;
+		}
+
+		return omega;
+	}
+
+	while ( n > 1 )
+	{
+		p = sv->spf[ n >> 1 ];
+		addFactor( f, p );
+		n /= p;
+		omega++;
+	}
+
+	return omega;
+}
+
+
+/*
+   Find all the divisors 'a' of 'n' such that
+   2 <= 'a' <= sqrt( 'n' ) - each one is the
+   smaller factor of a pair of factors of 'n' -
+   and store them into 'a' in the ascending order
+
+   They are generated straight from the prime
+   factorization of 'n', 'a' must have room for
+   MAX_DIVISORS / 2 of them
+
+   Returns the number of such divisors
+ */
+extern int
+factorPairs( sieve_t* sv, int n, int* a )
+{
+	factors_t	f;
+	int		divs[ MAX_DIVISORS ];
+	int		ndivs = 1;
+	int		nd;
+	int		i;
+	int		j;
+	int		k;
+	int		d;
+	int		cnt = 0;
+
+
+	factorize( sv, n, &f );
+
+	/*
+	   Multiply each divisor found so far by
+	   every power of the next prime
+	 */
+	divs[ 0 ] = 1;
+	for ( i = 0; i < f.n; i++ )
+	{
+		nd = ndivs;
+		for ( j = 0; j < nd; j++ )
+		{
+			d = divs[ j ];
+			for ( k = 0; k < f.e[ i ]; k++ )
+			{
+				d *= f.p[ i ];
+				divs[ ndivs++ ] = d;
+			}
+		}
+	}
+
+	for ( i = 0; i < ndivs; i++ )
+	{
+		d = divs[ i ];
+		if ( d < 2 || ( long long )d * d > n )
+		{
+			continue;
+		}
+
+		/*
+		   Insertion sort, there is only a handful
+		 */
+		for ( j = cnt; j > 0 && a[ j - 1 ] > d; j-- )
+		{
+			a[ j ] = a[ j - 1 ];
+		}
+		a[ j ] = d;
+		cnt++;
+	}
+
+	return cnt;
+}
+
+
+/*
+   factorize() for a 64-bit 'n': the 32-bit one
+   does it all if 'n' fits in an int, otherwise
+   'n' is tried against the sieved primes (and
+   the odd numbers past them) until what is left
+   of it does
+
+   Returns the number of prime factors counted
+   with their multiplicity, 0 for 'n' below 2
+ */
+extern int
+factorize64( sieve_t* sv, prod_t n, factors64_t* f )
+{
+	factors_t	f32;
+	int		i;
+	prod_t		p = 2;
+	int		omega = 0;
+
+
+	f->n = 0;
+
+	for ( i = 0; n > INT_MAX; i++ )
+	{
+		if ( i < sv->nPrimes )
+		{
+			p = sv->primes[ i ];
+		}
+		else
+		{
+			p = i == sv->nPrimes ? ( sv->limit + 1 ) | 1 : p + 2;
+		}
+
+		if ( p * p > n )
+		{
+			/*
+			   Whatever is left over is a prime
+			 */
+			addFactor64( f, n );
+			return omega + 1;
+		}
+
+		while ( n % p == 0 )
+		{
+			addFactor64( f, p );
+			n /= p;
+			omega++;
+		}
+	}
+
+	omega += factorize( sv, ( int )n, &f32 );
+	for ( i = 0; i < f32.n; i++ )
+	{
+		addFactor64( f, f32.p[ i ] );
+		f->e[ f->n - 1 ] += f32.e[ i ] - 1;
+	}
+
+	return omega;
+}
+
+
+/*
+   Break the product of 'x' and 'y' down into its
+   prime factors by those of 'x' and 'y', which
+   the 32-bit factorize() finds by the smallest
+   prime factor table as long as both are within
+   the sieve
+
+   Returns the number of prime factors counted
+   with their multiplicity
+ */
+extern int
+factorizePair( sieve_t* sv, int x, int y, factors64_t* f )
+{
+	factors_t	fx;
+	factors_t	fy;
+	int		i = 0;
+	int		j = 0;
+	int		omega;
+
+
+	omega = factorize( sv, x, &fx ) + factorize( sv, y, &fy );
+
+	/*
+	   Merge the two ascending lists
+	 */
+	f->n = 0;
+	while ( i < fx.n || j < fy.n )
+	{
+		if ( j == fy.n || ( i < fx.n && fx.p[ i ] < fy.p[ j ] ) )
+		{
+			f->p[ f->n ] = fx.p[ i ];
+			f->e[ f->n ] = fx.e[ i++ ];
+		}
+		else if ( i == fx.n || fy.p[ j ] < fx.p[ i ] )
+		{
+			f->p[ f->n ] = fy.p[ j ];
+			f->e[ f->n ] = fy.e[ j++ ];
+		}
+		else
+		{
+			f->p[ f->n ] = fx.p[ i ];
+			f->e[ f->n ] = fx.e[ i++ ] + fy.e[ j++ ];
+		}
+		f->n++;
+	}
+
+	return omega;
+}
+
+
+/*
+   factorPairs() for a 64-bit 'n' below
+   MAX_PRODUCT, 'a' must have room for
+   MAX_DIVISORS64 / 2 divisors
+
+   An 'n' that fits in an int goes the
+   32-bit way
+ */
+extern int
+factorPairs64( sieve_t* sv, prod_t n, prod_t* a )
+{
+	factors64_t	f;
+	int		pairs[ MAX_DIVISORS / 2 ];
+	int		na;
+	int		i;
+
+
+	if ( n <= INT_MAX )
+	{
+		na = factorPairs( sv, ( int )n, pairs );
+		for ( i = 0; i < na; i++ )
+		{
+			a[ i ] = pairs[ i ];
+		}
+
+		return na;
+	}
+
+	factorize64( sv, n, &f );
+
+	return divisorPairs( &f, n, a );
+}
+
+
+/*
+   factorPairs64() of the product of 'x'
+   and 'y', by way of factorizePair()
+ */
+extern int
+factorPairsOf( sieve_t* sv, int x, int y, prod_t* a )
+{
+	factors64_t	f;
+
+
+	factorizePair( sv, x, y, &f );
+
+	return divisorPairs( &f, ( prod_t )x * y, a );
+}
+
+
+/*
+   The divisors of 'n', factored into 'f', that
+   are the smaller factors of its pairs of factors,
+   see factorPairs(), in the ascending order
+
+   Those that do not exceed the square root are
+   generated straight into 'a', a divisor past it
+   is dropped at once: multiplying it by more
+   primes only takes it further
+ */
+static int
+divisorPairs( factors64_t* f, prod_t n, prod_t* a )
+{
+	int		na = 1;
+	int		nd;
+	int		i;
+	int		j;
+	int		k;
+	prod_t		d;
+
+
+	a[ 0 ] = 1;
+	for ( i = 0; i < f->n; i++ )
+	{
+		nd = na;
+		for ( j = 0; j < nd; j++ )
+		{
+			d = a[ j ];
+			for ( k = 0; k < f->e[ i ]; k++ )
+			{
+				d *= f->p[ i ];
+				if ( d > n / d )
+				{
+					break;
+				}
+				a[ na++ ] = d;
+			}
+		}
+	}
+
+	/*
+	   Drop the 1 and sort the rest, by
+	   insertion while there is only a
+	   handful of them
+	 */
+	na--;
+	memmove( a, a + 1, na * sizeof( prod_t ) );
+
+	if ( na > 32 )
+	{
+		qsort( a, na, sizeof( prod_t ), cmpProds );
+		return na;
+	}
+
+	for ( i = 1; i < na; i++ )
+	{
+		d = a[ i ];
+		for ( j = i; j > 0 && a[ j - 1 ] > d; j-- )
+		{
+			a[ j ] = a[ j - 1 ];
+		}
+		a[ j ] = d;
+	}
+
+	return na;
+}
+
+static void
+addFactor( factors_t* f, int p )
+{
+	if ( f->n > 0 && f->p[ f->n - 1 ] == p )
+	{
+		f->e[ f->n - 1 ]++;
+		return;
+	}
+
+	f->p[ f->n ] = p;
+	f->e[ f->n ] = 1;
+	f->n++;
+}
+
+
+static void
+addFactor64( factors64_t* f, prod_t p )
+{
+	if ( f->n > 0 && f->p[ f->n - 1 ] == p )
+	{
+		f->e[ f->n - 1 ]++;
+		return;
+	}
+
+	f->p[ f->n ] = p;
+	f->e[ f->n ] = 1;
+	f->n++;
+}
+
+
+static int
+cmpProds( const void* p1, const void* p2 )
+{
+	prod_t		a = *( const prod_t* )p1;
+	prod_t		b = *( const prod_t* )p2;
+
+
+	return a < b ? -1 : a > b;
+}
+
+
+/*
+   The integer square root, that
+   of a 64-bit 'n' with isqrt64()
+ */
+static int
+isqrt( int n )
+{
+	int		r = ( int )sqrt( ( double )n );
+
+
+	while ( r > 0 && ( long long )r * r > n )
+	{
+		r--;
+	}
+
+	while ( ( long long )( r + 1 ) * ( r + 1 ) <= n )
+	{
+		r++;
+	}
+
+	return r;
+}
+
+
+extern prod_t
+isqrt64( prod_t n )
+{
+	prod_t		r = ( prod_t )sqrt( ( double )n );
+
+
+	while ( r > 0 && r * r > n )
+	{
+		r--;
+	}
+
+	while ( ( r + 1 ) * ( r + 1 ) <= n )
+	{
+		r++;
+	}
+
+	return r;
+}
+
+
+/*
+   Mark the semiprimes p * q, p <= q <= 'maxFactor'
+   both prime, in the words 'lo' through 'hi' - 1
+   of 'bits', a bit per number: the words are set
+   anew, so that ranges of words can be marked one
+   at a time, each by a thread of its own
+
+   'maxFactor' may not exceed 'limit'. For each p,
+   the q's that land in the range are a run of the
+   sieved primes, the first of which is searched for
+ */
+extern void
+markSemiprimes( sieve_t* sv, int maxFactor, uint64_t* bits, prod_t lo,
+	prod_t hi )
+{
+	prod_t		from = lo * 64;
+	prod_t		to = hi * 64; /* is past the last number */
+	prod_t		n;
+	prod_t		qlo;
+	prod_t		qhi;
+	int		i;
+	int		j;
+	int		k;
+	int		m;
+	int		p;
+
+
+	memset( bits + lo, 0, ( size_t )( hi - lo ) * sizeof( uint64_t ) );
+
+	for ( i = 0; i < sv->nPrimes; i++ )
+	{
+		p = sv->primes[ i ];
+		if ( p > maxFactor || ( prod_t )p * p >= to )
+		{
+			break;
+		}
+
+		qlo = ( from + p - 1 ) / p;
+		if ( qlo < p )
+		{
+			qlo = p;
+		}
+
+		qhi = ( to - 1 ) / p;
+		if ( qhi > maxFactor )
+		{
+			qhi = maxFactor;
+		}
+
+		/*
+		   The first of the primes from p on
+		   that is no less than 'qlo'
+		 */
+		j = i;
+		k = sv->nPrimes;
+		while ( j < k )
+		{
+			m = j + ( k - j ) / 2;
+			if ( sv->primes[ m ] < qlo )
+			{
+				j = m + 1;
+			}
+			else
+			{
+				k = m;
+			}
+		}
+
+		for ( ; j < sv->nPrimes && sv->primes[ j ] <= qhi; j++ )
+		{
+			n = ( prod_t )p * sv->primes[ j ];
+			bits[ n >> 6 ] |= ( uint64_t )1 << ( n & 63 );
+		}
+	}
+}
+
+
+/*
+   A plain sieve for the odd primes up
+   to 'n' - the ones that do the sieving
+
+   Returns their number, -1 if out of memory
+ */
+static int
+mkBasePrimes( int n, int** primes )
+{
+	char*		composite;
+	int		i;
+	int		j;
+	int		cnt = 0;
+
+
+	composite = ( char* )calloc( n + 1, 1 );
+	*primes = ( int* )malloc( ( n / 2 + 1 ) * sizeof( int ) );
+	if ( !composite || !*primes )
+	{
+		if ( composite )
+		{
+			free( composite );
+		}
+
+		return -1;
+	}
+
+	for ( i = 3; i <= n; i += 2 )
+	{
+		if ( composite[ i ] )
+		{
+			continue;
+		}
+
+		( *primes )[ cnt++ ] = i;
+		for ( j = i * i; j <= n; j += 2 * i )
+		{
+			composite[ j ] = 1;
+		}
+	}
+
+	free( composite );
+
+	return cnt;
+}
+
+
+/*
+   Cross out the odd multiples of the base
+   primes among the bits 'lo' through 'hi' - 1
+ */
+static void
+sieveSegment( sieve_t* sv, int* base, int nbase, int lo, int hi )
+{
+	int		i;
+	int		p;
+	long long	first;
+	long long	bit;
+
+
+	for ( i = 0; i < nbase; i++ )
+	{
+		p = base[ i ];
+
+		/*
+		   The first odd multiple of 'p' within
+		   the segment, but not below 'p' squared
+		 */
+		first = ( long long )p * p;
+		if ( first < 2LL * lo + 1 )
+		{
+			first = ( ( 2LL * lo + 1 + p - 1 ) / p ) * p;
+			if ( !( first & 1 ) )
+			{
+				first += p;
+			}
+		}
+
+		for ( bit = first / 2; bit < hi; bit += p )
+		{
+			sv->odd[ bit >> 6 ] &= ~( ( uint64_t )1 << ( bit & 63 ) );
+		}
+	}
+}
+
+
+/*
+   Collect the sieved primes into a list
+
+   Returns their number, -1 if out of memory
+ */
+static int
+mkPrimes( sieve_t* sv )
+{
+	int		n;
+	int		cnt = 1;
+	int		nwords = ( sv->limit / 2 + 1 + 63 ) / 64;
+	int		w;
+	uint64_t	word;
+
+
+	for ( w = 0; w < nwords; w++ )
+	{
+		cnt += __builtin_popcountll( sv->odd[ w ] );
+	}
+
+	sv->primes = ( int* )malloc( cnt * sizeof( int ) );
+	if ( !sv->primes )
+	{
+		return -1;
+	}
+
+	sv->primes[ 0 ] = 2;
+	sv->nPrimes = 1;
+
+	for ( w = 0; w < nwords; w++ )
+	{
+		for ( word = sv->odd[ w ]; word; word &= word - 1 )
+		{
+			n = 2 * ( w * 64 + __builtin_ctzll( word ) ) + 1;
+			sv->primes[ sv->nPrimes++ ] = n;
+		}
+	}
+
+	return sv->nPrimes;
+}
+
+
+/*
+   Record the smallest prime factor of every odd
+   number up to 'limit' (that of an even one is
+   plainly 2), visiting the odd primes in the
+   ascending order the first one to reach a
+   number is its smallest
+
+   Returns 0, -1 if out of memory
+ */
+static int
+mkSpf( sieve_t* sv )
+{
+	int		i;
+	int		p;
+	long long	m;
+
+
+	sv->spf = ( int* )calloc( sv->limit / 2 + 1, sizeof( int ) );
+	if ( !sv->spf )
+	{
+		return -1;
+	}
+
+	for ( i = 1; i < sv->nPrimes; i++ )
+	{
+		p = sv->primes[ i ];
+		sv->spf[ p >> 1 ] = p;
+
+		for ( m = ( long long )p * p; m <= sv->limit; m += 2 * p )
+		{
+			if ( !sv->spf[ m >> 1 ] )
+			{
+				sv->spf[ m >> 1 ] = p;
+			}
+		}
+	}
+
+	return 0;
+}
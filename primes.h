@@ -0,0 +1,118 @@
+#ifndef PRIMES_H
+#define PRIMES_H
+
+#include <stdint.h>
+
+
+/*
+   Primality engine shared by both solvers
+
+   A sieve of Eratosthenes is run once up to 'limit'
+   over the odd numbers only, one cache-sized segment
+   at a time, and is kept as a packed bitset. That
+   makes isPrime() a single bit test for any number
+   up to 'limit'; the rare number beyond it is tried
+   against the sieved primes instead
+
+   On request the sieve also keeps the smallest prime
+   factor of every number up to 'limit', which makes
+   factoring such a number take one step per prime
+   factor, and enumerating its divisors - one step
+   per divisor
+
+   The sieved primes also give the semiprimes, the
+   products of two of them, marked in a bitset by
+   markSemiprimes() a range of words at a time
+
+   The numbers themselves are ints, their products
+   are 64-bit: those that still fit in an int go the
+   32-bit way, a larger one is best factored by way
+   of the two numbers it is the product of
+ */
+typedef struct
+{
+	int		limit; /* is the largest number sieved */
+	uint64_t*	odd; /* bit 'i' is set iff 2 * 'i' + 1 is prime */
+	int		nPrimes;
+	int*		primes; /* all the primes up to 'limit', ascending */
+	int*		spf; /* smallest prime factor of odd 'n' at 'n' / 2, or NULL */
+} sieve_t;
+
+
+/*
+   No int below 2^31 has more than 9 distinct
+   prime factors or more than 1600 divisors
+ */
+#define MAX_PRIME_FACTORS	9
+#define MAX_DIVISORS		1600
+
+/*
+   Prime factorization: 'n' distinct primes 'p'
+   in the ascending order, each one raised to
+   the power of 'e'
+ */
+typedef struct
+{
+	int		n;
+	int		p[ MAX_PRIME_FACTORS ];
+	int		e[ MAX_PRIME_FACTORS ];
+} factors_t;
+
+
+/*
+   Products of two numbers take 64 bits: none below
+   2^48 - of two numbers below 2^24, that is - has
+   more than 12 distinct prime factors or more than
+   20736 divisors
+ */
+typedef int64_t		prod_t;
+
+#define MAX_PRODUCT		( ( prod_t )1 << 48 )
+#define MAX_PRIME_FACTORS64	12
+#define MAX_DIVISORS64		20736
+
+typedef struct
+{
+	int		n;
+	prod_t		p[ MAX_PRIME_FACTORS64 ];
+	int		e[ MAX_PRIME_FACTORS64 ];
+} factors64_t;
+
+
+extern sieve_t*		mkSieve( sieve_t*, int, int );
+extern void		rmSieve( sieve_t* );
+extern int		isPrimeBeyond( sieve_t*, int );
+extern int		factorize( sieve_t*, int, factors_t* );
+extern int		factorPairs( sieve_t*, int, int* );
+extern int		factorize64( sieve_t*, prod_t, factors64_t* );
+extern int		factorPairs64( sieve_t*, prod_t, prod_t* );
+extern int		factorizePair( sieve_t*, int, int, factors64_t* );
+extern int		factorPairsOf( sieve_t*, int, int, prod_t* );
+extern void		markSemiprimes( sieve_t*, int, uint64_t*, prod_t,
+				prod_t );
+extern prod_t		isqrt64( prod_t );
+
+
+static inline int
+isPrime( sieve_t* sv, int n )
+{
+	if ( n <= 2 )
+	{
+		return n == 2;
+	}
+
+	if ( !( n & 1 ) )
+	{
+		return 0;
+	}
+
+	if ( n > sv->limit )
+	{
+		return isPrimeBeyond( sv, n );
+	}
+
+	return ( sv->odd[ n >> 7 ] >> ( ( n >> 1 ) & 63 ) ) & 1;
+}
+
+
+#endif
@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "snap.h"
+#include "out.h"
+
+
+#define SNAP_BYTE_ORDER		0x01020304
+
+
+static uint64_t		alignUp( uint64_t );
+
+
+/*
+   Write the 'n' sections into a new snapshot
+   file 'path', of the solver's 'version'
+
+   Returns 0, -1 if the file can not be
+   written in full
+ */
+extern int
+writeSnap( const char* path, uint32_t version, const snapSection_t* sections,
+	int n )
+{
+	static const char	zeros[ SNAP_ALIGN ] = { 0 };
+	snapHeader_t	header;
+	snapEntry_t	entry;
+	out_t		out;
+	uint64_t	offset;
+	uint64_t	end;
+	int		fd;
+	int		i;
+	int		rv;
+
+
+	fd = open( path, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	if ( fd < 0 )
+	{
+		return -1;
+	}
+
+	if ( !mkOut( &out, fd ) )
+	{
+		rmOut( &out );
+		close( fd );
+		return -1;
+	}
+
+
+	/*
+	   Lay the sections out one after
+	   another past the table
+	 */
+	offset = alignUp( sizeof( header ) + n * sizeof( entry ) );
+	for ( i = 0; i < n; i++ )
+	{
+		offset = alignUp( offset + sections[ i ].size );
+	}
+
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.magic, SNAP_MAGIC, sizeof( header.magic ) );
+	header.version = version;
+	header.byteOrder = SNAP_BYTE_ORDER;
+	header.nSections = n;
+	header.size = offset;
+	outBytes( &out, ( const char* )&header, sizeof( header ) );
+
+	offset = alignUp( sizeof( header ) + n * sizeof( entry ) );
+	for ( i = 0; i < n; i++ )
+	{
+		memset( &entry, 0, sizeof( entry ) );
+		entry.id = sections[ i ].id;
+		entry.offset = offset;
+		entry.size = sections[ i ].size;
+		outBytes( &out, ( const char* )&entry, sizeof( entry ) );
+
+		offset = alignUp( offset + sections[ i ].size );
+	}
+
+
+	/*
+	   The sections, each one padded
+	   up to the next one
+	 */
+	end = sizeof( header ) + n * sizeof( entry );
+	for ( i = 0; i < n; i++ )
+	{
+		outBytes( &out, zeros, alignUp( end ) - end );
+		outBytes( &out, ( const char* )sections[ i ].p, sections[ i ].size );
+		end = alignUp( end ) + sections[ i ].size;
+	}
+	outBytes( &out, zeros, alignUp( end ) - end );
+
+	rv = rmOut( &out );
+
+	if ( close( fd ) < 0 )
+	{
+		rv = -1;
+	}
+
+	return rv;
+}
+
+
+/*
+   Map the snapshot file 'path' into memory,
+   provided it is one of the 'version' given
+
+   Returns NULL if it can not be mapped or
+   is not such a snapshot, 'snap' otherwise
+ */
+extern snap_t*
+mapSnap( snap_t* snap, const char* path, uint32_t version )
+{
+	struct stat	st;
+	int		fd;
+	uint32_t	i;
+	snapEntry_t*	entry;
+
+
+	memset( snap, 0, sizeof( snap_t ) );
+
+	fd = open( path, O_RDONLY );
+	if ( fd < 0 )
+	{
+		return NULL;
+	}
+
+	if ( fstat( fd, &st ) < 0 || ( size_t )st.st_size < sizeof( snapHeader_t ) )
+	{
+		close( fd );
+		return NULL;
+	}
+
+	snap->size = st.st_size;
+	snap->base = mmap( NULL, snap->size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+		fd, 0 );
+	close( fd );
+
+	if ( snap->base == MAP_FAILED )
+	{
+		snap->base = NULL;
+		return NULL;
+	}
+
+	snap->header = ( snapHeader_t* )snap->base;
+	snap->entries = ( snapEntry_t* )( snap->header + 1 );
+
+	if ( memcmp( snap->header->magic, SNAP_MAGIC, sizeof( snap->header->magic ) ) ||
+		snap->header->byteOrder != SNAP_BYTE_ORDER ||
+		snap->header->version != version ||
+		snap->header->size != snap->size ||
+		sizeof( snapHeader_t ) + ( uint64_t )snap->header->nSections *
+			sizeof( snapEntry_t ) > snap->size )
+	{
+		unmapSnap( snap );
+		return NULL;
+	}
+
+	for ( i = 0; i < snap->header->nSections; i++ )
+	{
+		entry = &snap->entries[ i ];
+		if ( entry->offset % SNAP_ALIGN || entry->offset > snap->size ||
+			entry->size > snap->size - entry->offset )
+		{
+			unmapSnap( snap );
+			return NULL;
+		}
+	}
+
+	return snap;
+}
+
+
+extern void
+unmapSnap( snap_t* snap )
+{
+	if ( snap->base )
+	{
+		munmap( snap->base, snap->size );
+	}
+
+	memset( snap, 0, sizeof( snap_t ) );
+}
+
+
+/*
+   Returns the section 'id' and its size
+   in bytes, NULL if there is no such one
+ */
+extern void*
+snapSection( snap_t* snap, uint32_t id, uint64_t* size )
+{
+	uint32_t	i;
+
+
+	for ( i = 0; i < snap->header->nSections; i++ )
+	{
+		if ( snap->entries[ i ].id == id )
+		{
+			*size = snap->entries[ i ].size;
+			return ( char* )snap->base + snap->entries[ i ].offset;
+		}
+	}
+
+	return NULL;
+}
+
+
+static uint64_t
+alignUp( uint64_t n )
+{
+	return ( n + SNAP_ALIGN - 1 ) / SNAP_ALIGN * SNAP_ALIGN;
+}
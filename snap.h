@@ -0,0 +1,78 @@
+#ifndef SNAP_H
+#define SNAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/*
+   Binary snapshots of a solver's state
+
+   A snapshot file is a header, a table of its
+   sections and the sections themselves, each one
+   starting at a multiple of SNAP_ALIGN: it is
+   mapped into memory as a whole and the arrays
+   in it are used right where they are, nothing
+   is parsed or copied
+
+   The mapping is private, the solver is free to
+   change the arrays - the file stays as it is
+
+   What the sections are is up to the solver, as
+   is its own 'version' of them; the numbers are
+   kept in the byte order of the machine, a file
+   written on a machine of the other order is
+   not loaded
+ */
+#define SNAP_MAGIC		"FRSNAP\r\n"
+#define SNAP_ALIGN		64
+
+typedef struct
+{
+	char		magic[ 8 ];
+	uint32_t	version;
+	uint32_t	byteOrder; /* 0x01020304 as written */
+	uint32_t	nSections;
+	uint32_t	reserved;
+	uint64_t	size; /* of the whole file */
+} snapHeader_t;
+
+typedef struct
+{
+	uint32_t	id;
+	uint32_t	reserved;
+	uint64_t	offset; /* from the start of the file */
+	uint64_t	size;
+} snapEntry_t;
+
+
+/*
+   A section to write
+ */
+typedef struct
+{
+	uint32_t	id;
+	const void*	p;
+	uint64_t	size;
+} snapSection_t;
+
+
+/*
+   A snapshot mapped into memory
+ */
+typedef struct
+{
+	void*		base;
+	size_t		size;
+	snapHeader_t*	header;
+	snapEntry_t*	entries;
+} snap_t;
+
+
+extern int		writeSnap( const char*, uint32_t, const snapSection_t*, int );
+extern snap_t*		mapSnap( snap_t*, const char*, uint32_t );
+extern void		unmapSnap( snap_t* );
+extern void*		snapSection( snap_t*, uint32_t, uint64_t* );
+
+
+#endif
@@ -0,0 +1,92 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "store.h"
+
+
+/*
+   Create the scratch file 'path' of 'size'
+   bytes, all zeros, and map it
+
+   Returns NULL if it can not be created or
+   mapped, 'store' otherwise
+ */
+extern store_t*
+mkStore( store_t* store, const char* path, size_t size )
+{
+	memset( store, 0, sizeof( store_t ) );
+
+	store->size = size > 0 ? size : 1;
+	store->fd = open( path, O_RDWR | O_CREAT | O_TRUNC, 0600 );
+	if ( store->fd < 0 )
+	{
+		return NULL;
+	}
+
+	unlink( path );
+
+	if ( ftruncate( store->fd, store->size ) < 0 )
+	{
+		rmStore( store );
+		return NULL;
+	}
+
+	store->base = ( char* )mmap( NULL, store->size, PROT_READ | PROT_WRITE,
+		MAP_SHARED, store->fd, 0 );
+	if ( store->base == MAP_FAILED )
+	{
+		store->base = NULL;
+		rmStore( store );
+		return NULL;
+	}
+
+	madvise( store->base, store->size, MADV_SEQUENTIAL );
+
+	return store;
+}
+
+
+extern void
+rmStore( store_t* store )
+{
+	if ( store->base )
+	{
+		munmap( store->base, store->size );
+	}
+
+	if ( store->fd > 0 )
+	{
+		close( store->fd );
+	}
+
+	memset( store, 0, sizeof( store_t ) );
+}
+
+
+/*
+   Returns 'size' bytes of the store, all
+   zeros, NULL if it has no room for them
+ */
+extern void*
+storeAlloc( store_t* store, size_t size )
+{
+	void*		p;
+
+
+	if ( size > store->size - store->used )
+	{
+		return NULL;
+	}
+
+	p = store->base + store->used;
+	store->used += storeSize( size );
+	if ( store->used > store->size )
+	{
+		store->used = store->size;
+	}
+
+	return p;
+}
@@ -0,0 +1,57 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <stddef.h>
+
+
+/*
+   Out-of-core storage for the arrays that do not
+   fit in memory
+
+   The arrays are carved out of one file mapped
+   into memory, shared, so that the kernel pages
+   them in and out on its own. The file is a
+   scratch one: it is unlinked as soon as it is
+   mapped and is gone once the store is
+
+   mkStore() makes the file as large as the
+   caller asks for up front, storeAlloc() hands
+   it out an array at a time and nothing is
+   given back until rmStore(). The mapping is
+   advised to be read ahead: the arrays are
+   meant to be filled and walked in their order,
+   as cfreudenthal does with the cells of its
+   matrix, so that the kernel writes back what
+   is behind and reads in what is ahead. An
+   array written all over would be written
+   back over and over: such ones are kept
+   off the store
+
+   Every array starts on a page of its own,
+   a caller adds up storeSize() of each one
+   to get the size of the store
+ */
+#define STORE_ALIGN		4096
+
+typedef struct
+{
+	int		fd;
+	char*		base;
+	size_t		size;
+	size_t		used;
+} store_t;
+
+
+extern store_t*		mkStore( store_t*, const char*, size_t );
+extern void		rmStore( store_t* );
+extern void*		storeAlloc( store_t*, size_t );
+
+
+static inline size_t
+storeSize( size_t n )
+{
+	return ( n + STORE_ALIGN - 1 ) / STORE_ALIGN * STORE_ALIGN;
+}
+
+
+#endif